@@ -46,6 +46,8 @@
 #include <fstream>
 #include "SKALE/Skeleton.hpp"
 #include "SKALE/IKSolver.hpp"
+#include "SKALE/FixedTimestep.hpp"
+#include "SKALE/SkeletonJournal.hpp"
 #include <math.h>
 
 skl::IKSolver solver;
@@ -65,6 +67,16 @@ int mouseY;
 int startX;
 int startY;
 
+//Animation, IK and FK tick at 60 Hz whatever the display runs at
+skl::FixedTimestep* stepper = NULL;
+double lastTime = 0.0;
+std::vector<float> renderX;
+std::vector<float> renderY;
+std::vector<float> renderAngle;
+
+//Every drag is written to Skeleton.txt.journal as it happens
+skl::SkeletonJournal* journal = NULL;
+
 
 bool Inisde(float x,float y,float l,float t,float r,float b )
 {
@@ -166,41 +178,57 @@ void buildSkeleton()
 
 }
 
-void renderSkeleton(skl::Bone* root)
+void renderSkeleton()
 {
-	if(root->getParent())
-	{
-
-		al_draw_scaled_rotated_bitmap(rope,al_get_bitmap_width(rope) / 2.0f,
-			0,
-			root->getParent()->getFrameX(), root->getParent()->getFrameY(),0.1f,(root->getLength() * 1.1f) /
-			al_get_bitmap_height(rope) ,root->getFrameAngle() - (3.1415f / 2.0f),0);
-
-		al_draw_line(
-			root->getParent()->getFrameX(),root->getParent()->getFrameY(),
-			root->getFrameX(),root->getFrameY(),al_map_rgb(255,0,0),1.0f);
-		al_draw_filled_circle(root->getFrameX(),root->getFrameY(),4.0f,al_map_rgb(50,200,0));
-
-	}
-	else
+	//Draw the pose blended between the last two ticks
+	const skl::FlatSkeleton& flat = skeleton.getFlatBones();
+	int n = stepper->count();
+	renderX.resize(n);
+	renderY.resize(n);
+	renderAngle.resize(n);
+	stepper->interpolatedFrame(stepper->getAlpha(),&renderX[0],&renderY[0],&renderAngle[0]);
+
+	for(int i = 0; i < n; ++i)
 	{
-		al_draw_filled_circle(root->getFrameX(),root->getFrameY(),4.0f,al_map_rgb(50,200,0));
+		int parent = flat.getParentIndex(i);
+		if(parent >= 0)
+		{
+			al_draw_scaled_rotated_bitmap(rope,al_get_bitmap_width(rope) / 2.0f,
+				0,
+				renderX[parent], renderY[parent],0.1f,(flat.getBone(i)->getLength() * 1.1f) /
+				al_get_bitmap_height(rope) ,renderAngle[i] - (3.1415f / 2.0f),0);
+
+			al_draw_line(
+				renderX[parent],renderY[parent],
+				renderX[i],renderY[i],al_map_rgb(255,0,0),1.0f);
+		}
+		al_draw_filled_circle(renderX[i],renderY[i],4.0f,al_map_rgb(50,200,0));
 	}
+}
+
+skl::Bone* boneUnderMouse = NULL;
+bool ikPending = false;
+float ikTargetX;
+float ikTargetY;
 
-	for(std::list<skl::Bone>::iterator it = root->begin(); it != root->end(); ++it)
+//Solves toward the last mouse position, once per tick
+void tick(skl::Skeleton* skel, float step, void* userData)
+{
+	if(boneUnderMouse && ikPending)
 	{
-		renderSkeleton(&(*it));
+		solver.solve(skel,boneUnderMouse,ikTargetX,ikTargetY);
+		journal->record();
 	}
+	ikPending = false;
 }
 
-skl::Bone* boneUnderMouse = NULL;
-
 void render()
 {
 	al_clear_to_color(al_map_rgb(240,240,240));
-	skeleton.processAnimation();
-	skeleton.updateBones();
-	renderSkeleton(skeleton.getRoot());
+	double now = al_get_time();
+	stepper->advance((float)(now - lastTime));
+	lastTime = now;
+	renderSkeleton();
 	al_flip_display();
 }
 
@@ -208,6 +236,12 @@ int main(int argc, char *argv[])
 {
 	initializeAllegro();
 	buildSkeleton();
+	skl::FixedTimestep fixedStep(&skeleton,1.0f / 60.0f);
+	fixedStep.setTickFunction(tick);
+	stepper = &fixedStep;
+	skl::SkeletonJournal skeletonJournal(&skeleton,"Skeleton.txt");
+	journal = &skeletonJournal;
+	lastTime = al_get_time();
 
 	bool needRedraw = true;
 	// Start the event queue to handle keyboard input, mouse and our timer
@@ -254,10 +288,9 @@ int main(int argc, char *argv[])
 		break;
 	case ALLEGRO_EVENT_MOUSE_AXES:
 		if(boneUnderMouse) {
-			solver.solve(
-				&skeleton,boneUnderMouse,(float)event.mouse.x,(float)event.mouse.y);
-			skeleton.updateBones();
-			//skeleton.save("Skeleton.txt");
+			ikTargetX = (float)event.mouse.x;
+			ikTargetY = (float)event.mouse.y;
+			ikPending = true;
 		}
 		break;
 	case ALLEGRO_EVENT_MOUSE_BUTTON_UP:
@@ -0,0 +1,90 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef SKALE_ANIMATION_CLIP_HPP
+#define SKALE_ANIMATION_CLIP_HPP
+#include <vector>
+#include "SKALE/platform.hpp"
+namespace skl
+{
+	class Rig;
+	class Skeleton;
+	class SkeletonInstance;
+
+	//Animation asset that can be shared by any number of instances of a Rig.
+	//Every track animates one channel of one bone (a Rig index). The keys of
+	//all tracks are packed into two arrays, track after track, so sampling
+	//a clip walks its memory once from front to back.
+	//Clips are not tied to one Rig: sampling into an instance fails when a
+	//track names a bone the instance does not have.
+	class AnimationClip
+	{
+	public:
+		enum Channel
+		{
+			CHANNEL_X,
+			CHANNEL_Y,
+			CHANNEL_ANGLE,
+			CHANNEL_LENGTH
+		};
+	private:
+		struct Track
+		{
+			int bone;
+			Channel channel;
+			size_t first;
+			size_t count;
+		};
+		std::vector<Track> mTracks;
+		std::vector<float> mFrames;
+		std::vector<float> mValues;
+		float mLength;
+		float _sampleTrack(const Track& track, float frame) const;
+	public:
+		AnimationClip(void);
+		bool build(const Rig& rig, Skeleton& skeleton);
+		void clear();
+		int addTrack(int bone, Channel channel);
+		bool addKey(float frame, float value);
+		size_t getTrackCount() const;
+		int getTrackBone(size_t track) const;
+		Channel getTrackChannel(size_t track) const;
+		size_t getKeyCount(size_t track) const;
+		const float* getKeyFrames(size_t track) const;
+		const float* getKeyValues(size_t track) const;
+		float getLength() const;
+		size_t getMemoryUsage() const;
+		bool fitsBoneCount(int boneCount) const;
+		void sample(float frame, float* x, float* y, float* angle, float* length) const;
+		bool sample(float frame, SkeletonInstance& instance) const;
+		virtual ~AnimationClip(void);
+	};
+}
+#endif
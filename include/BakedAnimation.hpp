@@ -0,0 +1,75 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef SKALE_BAKED_ANIMATION_HPP
+#define SKALE_BAKED_ANIMATION_HPP
+#include <vector>
+#include "SKALE/platform.hpp"
+namespace skl
+{
+	class Rig;
+	class AnimationClip;
+
+	//World frames of every bone of a Rig playing a clip, recorded at a fixed
+	//frame step. Playing it back is a lerp between two table rows with no
+	//FK at all, meant for crowds. Rows are recorded with the root at the
+	//origin and sample() moves them to the entity's position. The last row
+	//is always the clip's final frame, even when the clip length is not a
+	//multiple of the frame step.
+	class BakedAnimation
+	{
+		int mBoneCount;
+		size_t mRowCount;
+		float mFrameStep;
+		float mLength;
+		bool mLooping;
+		std::vector<float> mTable; //Per row: frameX, frameY, frameAngle for every bone
+	public:
+		BakedAnimation(void);
+		bool bake(const Rig& rig, const AnimationClip& clip, float frameStep = 1.0f);
+		void clear();
+		int getBoneCount() const;
+		size_t getRowCount() const;
+		float getFrameStep() const;
+		float getRowFrame(size_t row) const;
+		float getLength() const;
+		void setLooping(bool looping);
+		bool isLooping() const;
+		const float* getRowX(size_t row) const;
+		const float* getRowY(size_t row) const;
+		const float* getRowAngle(size_t row) const;
+		size_t getMemoryUsage() const;
+		float getPlaybackOffset(size_t instance) const;
+		void sample(float frame, float* frameX, float* frameY, float* frameAngle,
+			float x = 0.0f, float y = 0.0f) const;
+		virtual ~BakedAnimation(void);
+	};
+}
+#endif
@@ -0,0 +1,85 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef SKALE_BLEND_STACK_HPP
+#define SKALE_BLEND_STACK_HPP
+#include <vector>
+#include "SKALE/platform.hpp"
+#include "SKALE/PoseArena.hpp"
+namespace skl
+{
+	class Rig;
+	class AnimationClip;
+	class SkeletonInstance;
+
+	//Layers of clips applied bottom to top over an instance's current pose.
+	//Each layer samples its clip into a temporary pose and mixes it over the
+	//result so far by its weight times its per bone mask. Crossfade two clips
+	//with two full layers, or mask a layer to a subtree to play it over the
+	//rest. Channels a clip has no track for pass through unchanged.
+	//Many stacks can share one arena that the caller resets every frame.
+	//evaluate returns false for an instance of another rig or a full arena.
+	class BlendStack
+	{
+		struct Layer
+		{
+			const AnimationClip* clip;
+			float frame;
+			float weight;
+			std::vector<float> mask; //Empty when every bone has weight 1
+		};
+		const Rig* mRig;
+		std::vector<Layer> mLayers;
+		PoseArena mArena;
+		bool _isValid(int layer) const;
+	public:
+		explicit BlendStack(const Rig* rig);
+		const Rig* getRig() const;
+		int addLayer(const AnimationClip* clip, float weight = 1.0f);
+		bool removeLayer(int layer);
+		void clear();
+		int count() const;
+		void setClip(int layer, const AnimationClip* clip);
+		const AnimationClip* getClip(int layer) const;
+		void setFrame(int layer, float frame);
+		float getFrame(int layer) const;
+		void setWeight(int layer, float weight);
+		float getWeight(int layer) const;
+		void setMask(int layer, int bone, float weight);
+		void setMaskSubtree(int layer, int bone, float weight);
+		void clearMask(int layer);
+		float getMask(int layer, int bone) const;
+		size_t getArenaSize() const;
+		bool evaluate(SkeletonInstance& instance, PoseArena& arena) const;
+		bool evaluate(SkeletonInstance& instance);
+		virtual ~BlendStack(void);
+	};
+}
+#endif
@@ -36,6 +36,29 @@
 #include "SKALE/KeyFrame.hpp"
 namespace skl
 {
+	#define SK_BONE_INDEX_BITS 20
+	#define SK_BONE_INDEX_MASK ((1 << SK_BONE_INDEX_BITS) - 1)
+	#define SK_BONE_GENERATION_MASK 0x7FF
+
+	//Handle of a bone in its Skeleton. The low bits index a slot, the high
+	//bits hold the slot's generation so handles to removed bones stop
+	//resolving once the slot is reused. A default handle refers to nothing.
+	//It is a distinct type so plain ints and NULL never convert to it.
+	struct BoneId
+	{
+		int packed; //-1 when invalid
+
+		BoneId() : packed(-1) {}
+		explicit BoneId(int value) : packed(value) {}
+		BoneId(int index, int generation)
+			: packed(index | ((generation & SK_BONE_GENERATION_MASK) << SK_BONE_INDEX_BITS)) {}
+		bool isValid() const { return packed >= 0; }
+		int getIndex() const { return packed & SK_BONE_INDEX_MASK; }
+		int getGeneration() const { return packed >> SK_BONE_INDEX_BITS; }
+		bool operator==(const BoneId& other) const { return packed == other.packed; }
+		bool operator!=(const BoneId& other) const { return packed != other.packed; }
+	};
+
 	//NOTE: This class does not do any logical verifications when setting values
 	class Bone
 	{
@@ -49,6 +72,7 @@ namespace skl
 		std::string mName;
 		Bone* mParent;
 		std::list<Bone> children;
+		std::list<Bone>::iterator mSelf; //Position in the parent's children
 		std::vector<KeyFrame> mKeyFrames;
 		bool mFixture;
 		float mFrameX;
@@ -61,6 +85,9 @@ namespace skl
 		int remainingInterpolationFrames;
 		float curIncreaseAngle;
 		int framesPerSecond;
+		bool mDirty;
+		bool mDirtyChildren;
+		BoneId mId;
 		void interpolateIncreaseAngle();
 	public:
 		Bone(float x, float y, float angle, float length,
@@ -83,12 +110,16 @@ namespace skl
 		void setMaxAngle(float maxAngle);
 		const float& getMinAngle() const;
 		const float& getMaxAngle() const;
+		bool hasAngleLimits() const;
+		float constrainAngle(float angle) const;
 		void setLength(float length);
 		const float& getLength() const;
 		void setRelative(bool relative);
 		bool isRelative() const;
 		std::list<Bone>::iterator begin();
 		std::list<Bone>::iterator end();
+		std::list<Bone>::const_iterator begin() const;
+		std::list<Bone>::const_iterator end() const;
 		Bone* getParent() const;
 		void setName(const std::string &name);
 		const std::string& getName() const;
@@ -97,12 +128,21 @@ namespace skl
 		const float& getFrameX() const;
 		const float& getFrameY() const;
 		const float& getFrameAngle() const;
+		void markDirty();
+		void clearDirty();
+		bool isDirty() const;
+		bool hasDirtyChildren() const;
+		void setId(BoneId id);
+		BoneId getId() const;
 		void setAsFixture(bool fixture);
 		bool isFixture() const;
 		void addKeyFrame(const KeyFrame& keyFrame);
 		void addKeyFrames(const std::vector<KeyFrame>& keyFrames);
 		void resetAnimation();
 		void processAnimation();
+		const std::vector<KeyFrame>& getKeyFrames() const;
+		void sampleAnimation(float frame);
+		KeyFrameReduction reduceKeyFrames(float tolerance);
 		virtual ~Bone(void);
 	};
 }
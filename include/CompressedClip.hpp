@@ -0,0 +1,81 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef SKALE_COMPRESSED_CLIP_HPP
+#define SKALE_COMPRESSED_CLIP_HPP
+#include <vector>
+#include "SKALE/platform.hpp"
+#include "SKALE/AnimationClip.hpp"
+namespace skl
+{
+	class SkeletonInstance;
+
+	//Read only, quantized copy of an AnimationClip that is sampled directly.
+	//Values are stored as 16 bit steps within each track's range, frames as
+	//16 bit deltas with the absolute frame of every 16th key kept for the
+	//search, and tracks that barely move collapse to a single value.
+	//Angle tracks are unwrapped first, so their samples may differ from the
+	//source clip by whole turns.
+	//Like AnimationClip, sampling into an instance checks the track bones.
+	class CompressedClip
+	{
+		struct Track
+		{
+			int bone;
+			AnimationClip::Channel channel;
+			float minValue;
+			float scale;
+			float lastFrame;
+			size_t keyCount;
+			size_t firstKey;
+			size_t firstBlock;
+		};
+		std::vector<Track> mTracks;
+		std::vector<unsigned short> mValues;
+		std::vector<unsigned short> mDeltas;
+		std::vector<unsigned int> mBlockFrames;
+		float mLength;
+		float mErrorBound;
+		float _sampleTrack(const Track& track, float frame) const;
+	public:
+		CompressedClip(void);
+		bool compress(const AnimationClip& clip, float constantTolerance = 0.0001f);
+		void clear();
+		size_t getTrackCount() const;
+		float getLength() const;
+		float getErrorBound() const;
+		size_t getMemoryUsage() const;
+		bool fitsBoneCount(int boneCount) const;
+		void sample(float frame, float* x, float* y, float* angle, float* length) const;
+		bool sample(float frame, SkeletonInstance& instance) const;
+		virtual ~CompressedClip(void);
+	};
+}
+#endif
@@ -0,0 +1,83 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef SKALE_CURVE_CLIP_HPP
+#define SKALE_CURVE_CLIP_HPP
+#include <vector>
+#include "SKALE/platform.hpp"
+#include "SKALE/AnimationClip.hpp"
+namespace skl
+{
+	class SkeletonInstance;
+
+	//Clip of cubic Hermite curves. Every key has a value and the slopes
+	//(value per frame) coming in and going out. The cubic of each segment is
+	//turned into polynomial coefficients as keys are added, so sampling a
+	//track is a search plus a Horner evaluation, run SK_SIMD_WIDTH tracks at
+	//a time. A Bezier handle at a third of a segment of length d is the
+	//same as a slope of 3 * (handle - value) / d.
+	//Angle keys are unwrapped against the previous key when added.
+	//Like AnimationClip, sampling into an instance checks the track bones.
+	class CurveClip
+	{
+		struct Track
+		{
+			int bone;
+			AnimationClip::Channel channel;
+			size_t first;
+			size_t count;
+		};
+		std::vector<Track> mTracks;
+		std::vector<float> mFrames;
+		std::vector<float> mValues;
+		std::vector<float> mOutSlopes;
+		//v(s) = ((a * s + b) * s + c) * s + d with s frames after the key
+		std::vector<float> mA;
+		std::vector<float> mB;
+		std::vector<float> mC;
+		std::vector<float> mD;
+		float mLength;
+		size_t _findKey(const Track& track, float frame) const;
+	public:
+		CurveClip(void);
+		bool build(const AnimationClip& clip);
+		void clear();
+		int addTrack(int bone, AnimationClip::Channel channel);
+		bool addKey(float frame, float value, float inSlope, float outSlope);
+		size_t getTrackCount() const;
+		size_t getKeyCount(size_t track) const;
+		float getLength() const;
+		bool fitsBoneCount(int boneCount) const;
+		void sample(float frame, float* x, float* y, float* angle, float* length) const;
+		bool sample(float frame, SkeletonInstance& instance) const;
+		virtual ~CurveClip(void);
+	};
+}
+#endif
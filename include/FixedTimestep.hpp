@@ -0,0 +1,78 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef SKALE_FIXED_TIMESTEP_HPP
+#define SKALE_FIXED_TIMESTEP_HPP
+#include <vector>
+#include "SKALE/platform.hpp"
+namespace skl
+{
+	class Skeleton;
+
+	//Called once per tick after animation and before FK, for IK or game logic
+	typedef void (*TickFunction)(Skeleton* skeleton, float step, void* userData);
+
+	//Runs a skeleton's animation, tick function and FK at a fixed rate no
+	//matter how often advance() is called. The world frames of the last two
+	//ticks are kept so rendering can blend between them with the alpha that
+	//advance() leaves behind. Bones are indexed as in getFlatBones().
+	class FixedTimestep
+	{
+		Skeleton* mSkeleton;
+		float mStep;
+		float mFramesPerSecond;
+		float mAccumulator;
+		float mTime;
+		size_t mMaxTicks;
+		TickFunction mTickFunction;
+		void* mUserData;
+		std::vector<float> mPrevious; //frameX, frameY, frameAngle per bone
+		std::vector<float> mCurrent;
+		void _capture();
+	public:
+		explicit FixedTimestep(Skeleton* skeleton, float step = 1.0f / 60.0f);
+		void setTickFunction(TickFunction function, void* userData = NULL);
+		void setStep(float step);
+		float getStep() const;
+		void setFramesPerSecond(float framesPerSecond);
+		float getFramesPerSecond() const;
+		void setMaxTicks(size_t ticks);
+		size_t getMaxTicks() const;
+		void setTime(float time);
+		float getTime() const;
+		int advance(float dt);
+		float getAlpha() const;
+		int count() const;
+		void interpolatedFrame(float alpha, float* frameX, float* frameY, float* frameAngle) const;
+		void interpolatedFrame(int index, float alpha, float& frameX, float& frameY, float& frameAngle) const;
+		virtual ~FixedTimestep(void);
+	};
+}
+#endif
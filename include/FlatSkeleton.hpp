@@ -0,0 +1,66 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef SKALE_FLAT_SKELETON_HPP
+#define SKALE_FLAT_SKELETON_HPP
+#include <vector>
+#include "SKALE/platform.hpp"
+#include "SKALE/Bone.hpp"
+namespace skl
+{
+	//Computes world frames for bones stored parent before child.
+	//A negative parent index marks a bone without a parent.
+	void updateFrames(const int* parents, const unsigned char* relative,
+		const float* x, const float* y, const float* angle, const float* length,
+		float* frameX, float* frameY, float* frameAngle, int first, int last);
+
+	//Depth first index of a bone hierarchy, so every subtree is the range
+	//[index, getSubtreeEnd(index)). Poses live in the Bones; for flat pose
+	//updates build a Rig from the skeleton and use SkeletonInstance, which
+	//owns its arrays and never copies them back into a tree.
+	class FlatSkeleton
+	{
+		std::vector<Bone*> mBones;
+		std::vector<int> mParents;
+		std::vector<int> mSubtreeEnds;
+		void _addBone(Bone* bone, int parent);
+	public:
+		FlatSkeleton(void);
+		void build(Bone* root);
+		void clear();
+		int count() const;
+		int indexOf(const Bone* bone) const;
+		Bone* getBone(int index) const;
+		int getParentIndex(int index) const;
+		int getSubtreeEnd(int index) const;
+		virtual ~FlatSkeleton(void);
+	};
+}
+#endif
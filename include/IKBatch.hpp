@@ -0,0 +1,91 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef SKALE_IK_BATCH_HPP
+#define SKALE_IK_BATCH_HPP
+#include <vector>
+#include <string>
+#include "SKALE/platform.hpp"
+#include "SKALE/IKSolver.hpp"
+#include "SKALE/ThreadPool.hpp"
+namespace skl
+{
+	class Skeleton;
+
+	struct IKJob
+	{
+		Skeleton* skeleton;
+		BoneId effector; //Resolved every solve, removed bones are skipped
+		float targetX;
+		float targetY;
+	};
+
+	struct IKResult
+	{
+		bool solved;
+		size_t iterations;
+	};
+
+	//Runs many IK solves per frame across a ThreadPool. Effectors are
+	//stored as handles when a job is added; afterwards only targets change.
+	//A job whose bone was removed reports unsolved with no iterations.
+	//Jobs on the same skeleton run in the order they were added, on one
+	//thread, so results do not depend on the number of threads.
+	//Each skeleton keeps its own solver between frames, so coherent
+	//mode warm starts work inside a batch.
+	class IKBatch
+	{
+		IKSolver mSolver; //Settings only, copied into the group solvers
+		std::vector<IKSolver> mGroupSolvers;
+		ThreadPool* mPool;
+		std::vector<IKJob> mJobs;
+		std::vector<IKResult> mResults;
+		std::vector<size_t> mGroupedJobs;
+		std::vector<size_t> mGroupStarts;
+		bool mGroupsValid;
+		void _buildGroups();
+		static void _solveGroups(size_t first, size_t last, void* userData);
+	public:
+		explicit IKBatch(ThreadPool* pool);
+		IKSolver& getSolver();
+		int add(Skeleton* skeleton, Bone* effector, float targetX, float targetY);
+		int add(Skeleton* skeleton, const std::string& boneName, float targetX, float targetY);
+		int add(Skeleton* skeleton, BoneId bone, float targetX, float targetY);
+		void setTarget(int job, float targetX, float targetY);
+		const IKJob& getJob(int job) const;
+		void clear();
+		int count() const;
+		void solve();
+		const IKResult& getResult(int job) const;
+		const IKResult* getResults() const;
+		virtual ~IKBatch(void);
+	};
+}
+#endif
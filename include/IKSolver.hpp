@@ -32,20 +32,68 @@
 #define SKALE_IK_SOLVER_HPP
 #include "SKALE/platform.hpp"
 #include "SKALE/Bone.hpp"
+#include <vector>
+#include <map>
 
 namespace skl
 {
 	class Skeleton;
 	class IKSolver
 	{
+	public:
+		enum Method
+		{
+			CCD,
+			FABRIK
+		};
+		enum BendDirection
+		{
+			BEND_KEEP,
+			BEND_POSITIVE,
+			BEND_NEGATIVE
+		};
+	private:
+		struct CoherentState
+		{
+			float targetX;
+			float targetY;
+			bool solved;
+			Skeleton* skeleton;
+			std::vector<BoneId> bones; //Checked before the angles are reused
+			std::vector<float> angles;
+		};
 		float mSolvedRadiusSquared;
 		bool mConstraints;
 		bool mFixtures;
 		size_t mMaxIter;
+		Method mMethod;
+		BendDirection mBendDirection;
+		bool mAnalyticTwoBone;
+		size_t mIterations;
+		bool mCoherent;
+		float mStallDistance;
+		std::map<Bone*,CoherentState> mCoherentStates;
+		std::vector<Bone*> mChain;
+		std::vector<float> mJointX;
+		std::vector<float> mJointY;
 		float _simplifyAngle(float angle) const;
-		float _constrainAngle(Bone* bone, float angle) const;
+		Bone* _getChainTop(Bone* targetBone) const;
+		int _gatherChain(Bone* targetBone);
+		bool _isTwoBoneChain(Bone* targetBone);
+		bool _isStalled(Bone* targetBone, float targetX, float targetY, float& lastDistance) const;
+		void _warmStart(Skeleton* skeleton,Bone* targetBone, float targetX, float targetY);
+		void _storeCoherentState(Skeleton* skeleton,Bone* targetBone, float targetX, float targetY,
+			bool solved);
+		bool _solveCCD(Skeleton* skeleton,Bone* targetBone, float targetX, float targetY);
+		bool _solveFABRIK(Skeleton* skeleton,Bone* targetBone, float targetX, float targetY);
 	public:
 		IKSolver(void);
+		void setMethod(Method method);
+		Method getMethod() const;
+		void setBendDirection(BendDirection direction);
+		BendDirection getBendDirection() const;
+		void setAnalyticTwoBone(bool analytic);
+		bool isUsingAnalyticTwoBone() const;
 		void setSolvedRadius(float radius);
 		float getSolvedRadiusSquared() const;
 		void setAngleLimits(bool limited);
@@ -54,9 +102,22 @@ namespace skl
 		bool isStoppingAtFixture() const;
 		void setMaxIterations(size_t iterations);
 		size_t getMaxIterations() const;
+		size_t getIterationCount() const;
+		void setCoherent(bool coherent);
+		bool isCoherent() const;
+		void setStallDistance(float distance);
+		float getStallDistance() const;
+		void clearCoherentStates();
+		void copySettings(const IKSolver& solver);
 		bool solveIteration(Bone* targetBone, float targetX, float targetY) const;
+		bool solveTwoBone(Skeleton* skeleton,Bone* targetBone, float targetX, float targetY);
 		bool solve(Skeleton* skeleton,Bone* targetBone, float targetX, float targetY);
 		bool solve(Skeleton* skeleton,const std::string& boneName, float targetX, float targetY);
+		bool solve(Skeleton* skeleton,Bone* targetBone, float targetX, float targetY, Method method);
+		bool solve(Skeleton* skeleton,const std::string& boneName, float targetX, float targetY,
+			Method method);
+		bool solve(Skeleton* skeleton,BoneId bone, float targetX, float targetY);
+		bool solve(Skeleton* skeleton,BoneId bone, float targetX, float targetY, Method method);
 		virtual ~IKSolver(void);
 	};
 }
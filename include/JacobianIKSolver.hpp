@@ -0,0 +1,91 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef SKALE_JACOBIAN_IK_SOLVER_HPP
+#define SKALE_JACOBIAN_IK_SOLVER_HPP
+#include <vector>
+#include "SKALE/platform.hpp"
+#include "SKALE/Bone.hpp"
+namespace skl
+{
+	class Skeleton;
+
+	struct IKEffector
+	{
+		Bone* bone;
+		float targetX;
+		float targetY;
+		float weight; //Effectors with more weight win where chains share bones
+	};
+
+	//Solves several end effectors together with damped least squares over
+	//the union of their chains. Each iteration performs one step for all
+	//effectors followed by one update of the affected bones.
+	class JacobianIKSolver
+	{
+		float mSolvedRadiusSquared;
+		bool mConstraints;
+		bool mFixtures;
+		size_t mMaxIter;
+		float mDamping;
+		float mMaxStep;
+		size_t mIterations;
+		std::vector<Bone*> mJoints;
+		std::vector<Bone*> mChainTops;
+		std::vector<int> mChainJoints;
+		std::vector<size_t> mChainStarts;
+		std::vector<float> mJacobian;
+		std::vector<float> mSystem;
+		std::vector<float> mError;
+		std::vector<float> mDelta;
+		int _addJoint(Bone* bone);
+		void _buildChains(const IKEffector* effectors, size_t count);
+		bool _solveSystem(int size);
+	public:
+		JacobianIKSolver(void);
+		void setSolvedRadius(float radius);
+		float getSolvedRadiusSquared() const;
+		void setAngleLimits(bool limited);
+		bool isAngleLimited() const;
+		void setStopAtFixture(bool stopping);
+		bool isStoppingAtFixture() const;
+		void setMaxIterations(size_t iterations);
+		size_t getMaxIterations() const;
+		void setDamping(float damping);
+		float getDamping() const;
+		void setMaxStep(float radians);
+		float getMaxStep() const;
+		size_t getIterationCount() const;
+		bool solve(Skeleton* skeleton, const IKEffector* effectors, size_t count);
+		bool solve(Skeleton* skeleton, const std::vector<IKEffector>& effectors);
+		virtual ~JacobianIKSolver(void);
+	};
+}
+#endif
@@ -30,6 +30,7 @@
  */
 #ifndef SKALE_KEYFRAME_HPP
 #define SKALE_KEYFRAME_HPP
+#include <vector>
 #include "SKALE/platform.hpp"
 class KeyFrame
 {
@@ -42,4 +43,23 @@ public:
 	const size_t& getFrame() const;
 	virtual ~KeyFrame(void);
 };
+
+//Value at a fractional frame of keys sorted by frame. Finds the surrounding
+//pair with a binary search and takes the shortest way around the circle.
+//Holds the first and last values outside the keyed range.
+float sampleKeyFrames(const std::vector<KeyFrame>& keyFrames, float frame);
+
+//Wraps an angle or angle difference into [-PI, PI], the short way around
+float shortestArc(float delta);
+
+struct KeyFrameReduction
+{
+	size_t originalCount;
+	size_t reducedCount;
+	float maxError; //radians
+};
+
+//Drops keys that interpolation between their neighbours reproduces to
+//within tolerance radians. Keys must be sorted by frame.
+KeyFrameReduction reduceKeyFrames(std::vector<KeyFrame>& keyFrames, float tolerance);
 #endif
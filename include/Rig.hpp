@@ -0,0 +1,78 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef SKALE_RIG_HPP
+#define SKALE_RIG_HPP
+#include <map>
+#include <string>
+#include <vector>
+#include "SKALE/platform.hpp"
+namespace skl
+{
+	class Skeleton;
+
+	//Immutable bone hierarchy shared by any number of SkeletonInstances.
+	//Bones are stored depth first with the root at index 0, in the same
+	//order as Skeleton::getFlatBones().
+	class Rig
+	{
+		std::vector<std::string> mNames;
+		std::map<std::string,int> mIndices;
+		std::vector<int> mParents;
+		std::vector<int> mSubtreeEnds;
+		std::vector<unsigned char> mRelative;
+		std::vector<unsigned char> mFixture;
+		std::vector<float> mMinAngle;
+		std::vector<float> mMaxAngle;
+		std::vector<float> mRestX;
+		std::vector<float> mRestY;
+		std::vector<float> mRestAngle;
+		std::vector<float> mRestLength;
+	public:
+		explicit Rig(Skeleton& skeleton);
+		int count() const;
+		int findBone(const std::string& name) const;
+		const std::string& getName(int index) const;
+		int getParentIndex(int index) const;
+		int getSubtreeEnd(int index) const;
+		bool isRelative(int index) const;
+		bool isFixture(int index) const;
+		const float& getMinAngle(int index) const;
+		const float& getMaxAngle(int index) const;
+		const int* getParents() const;
+		const unsigned char* getRelativeFlags() const;
+		const float* getRestX() const;
+		const float* getRestY() const;
+		const float* getRestAngle() const;
+		const float* getRestLength() const;
+		virtual ~Rig(void);
+	};
+}
+#endif
@@ -32,6 +32,8 @@
 #define SKALE_SKELETON_HPP
 #include "SKALE/platform.hpp"
 #include "SKALE/Bone.hpp"
+#include "SKALE/FlatSkeleton.hpp"
+#include "SKALE/SkeletonAsset.hpp"
 #include <map>
 #include <vector>
 namespace skl
@@ -40,33 +42,68 @@ namespace skl
 	{
 		Bone root;
 		std::map<std::string,Bone*> bones;
+		struct BoneSlot
+		{
+			Bone* bone; //NULL while the slot is free
+			int generation;
+			std::map<std::string,Bone*>::iterator entry;
+		};
+		std::vector<BoneSlot> boneSlots;
+		std::vector<int> freeSlots;
 		int boneAddedCount;
+		FlatSkeleton flatBones;
+		bool flatBonesValid;
+		std::string loadError;
+		mutable std::string saveBuffer;
+		mutable unsigned int saveCount;
 
-		void _updateBones(Bone* root,float realStartX, float realStartY, float realStartAngle);
+		void _resetIds();
+		BoneId _acquireId(Bone* bone, std::map<std::string,Bone*>::iterator entry);
+		void _releaseIds(Bone* root);
+		int _updateBones(Bone* root,float realStartX, float realStartY, float realStartAngle);
+		int _updateDirtyBones(Bone* root);
+		void _saveBones(const Bone* root, int level, std::string& out) const;
+		int _replayJournal(const char* text, size_t size);
 		void _processAnimation(Bone* root);
-		bool _getLinesFromFile(const std::string& fileName,
-			std::vector<std::string>& lines );
-		bool _sortLinesByLevel(std::vector<std::string>& lines,
-			std::vector<std::pair<int,std::string*> >& sortedList);
-		void _makeBonesFromSortedList(std::vector<std::pair<int,std::string*> >& sortedList);
+		void _sampleAnimation(Bone* root, float frame);
+		size_t _getAnimationLength(Bone* root);
+		float _getReach(Bone* root);
+		int _getDepth(Bone* root);
+		void _reduceKeyFrames(Bone* root, float tolerance, float parentError,
+			KeyFrameReduction& total);
 	public:
 		Skeleton(void);
 		bool contains(const std::string& name) const;
 		Bone* add(float x, float y, float angle, float length, float minAngle, float maxAngle,
 			const std::string& name, Bone* parent = NULL);
 		bool remove(Bone* bone);
+		bool remove(BoneId id);
 		int count() const;
 		Bone* getRoot();
 		Bone* getByName(const std::string& name);
+		BoneId resolve(const std::string& name) const;
+		Bone* getBone(BoneId id) const;
 		void updateBones();
+		int updateBones(Bone* bone);
+		int updateDirtyBones();
 		void renameBone(const std::string& oldName, const std::string& newName);
 		void renameBone(Bone* bone, const std::string& newName);
 		int findLevel(const Bone* bone) const;
 		bool save(const std::string& fileName) const;
 		bool load(const std::string& fileName);
+		bool parse(const char* text, size_t size);
+		const std::string& getLoadError() const;
+		unsigned int getSaveCount() const;
+		bool load(const SkeletonAsset& asset);
+		bool loadBinary(const std::string& fileName);
+		bool saveBinary(const std::string& fileName);
 		void setPosition(float x, float y);
 		void setAngle(float angle);
 		void processAnimation();
+		void sampleAnimation(float time, float framesPerSecond = 60.0f);
+		size_t getAnimationLength();
+		KeyFrameReduction reduceKeyFrames(float worldTolerance);
+		const FlatSkeleton& getFlatBones();
 		virtual ~Skeleton(void);
 	};
 }
@@ -0,0 +1,108 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef SKALE_SKELETON_ASSET_HPP
+#define SKALE_SKELETON_ASSET_HPP
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "SKALE/platform.hpp"
+
+#define SK_ASSET_MAGIC "SKAL"
+#define SK_ASSET_VERSION 1
+
+namespace skl
+{
+	class Skeleton;
+
+	//Binary skeleton file, little endian, every table 4 byte aligned:
+	//header, bones table, keyframes table, string table.
+	//Offsets are in bytes from the start of the file. Bones are depth first
+	//with the root first, so a parent always comes before its children.
+	struct SkeletonAssetHeader
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t fileSize;
+		uint32_t boneCount;
+		uint32_t bonesOffset;
+		uint32_t keyFrameCount;
+		uint32_t keyFramesOffset;
+		uint32_t stringsSize;
+		uint32_t stringsOffset;
+	};
+
+	struct SkeletonAssetBone
+	{
+		int32_t parent; //-1 for the root
+		uint32_t name; //Offset of a null terminated name in the string table
+		float x;
+		float y;
+		float angle;
+		float length;
+		float minAngle;
+		float maxAngle;
+		uint8_t relative;
+		uint8_t fixture;
+		uint16_t reserved;
+		uint32_t firstKeyFrame;
+		uint32_t keyFrameCount;
+	};
+
+	struct SkeletonAssetKeyFrame
+	{
+		uint32_t frame;
+		float value;
+	};
+
+	//Validated view over a skeleton file already in memory, for example a
+	//MappedFile. Nothing is parsed or copied, the accessors read the tables
+	//in place, so the memory must outlive the view.
+	class SkeletonAsset
+	{
+		const char* mData;
+		const SkeletonAssetHeader* mHeader;
+		const SkeletonAssetBone* mBones;
+		const SkeletonAssetKeyFrame* mKeyFrames;
+		const char* mStrings;
+	public:
+		SkeletonAsset(void);
+		bool open(const void* data, size_t size);
+		bool isOpen() const;
+		int count() const;
+		const SkeletonAssetBone& getBone(int index) const;
+		const char* getName(int index) const;
+		const SkeletonAssetKeyFrame* getKeyFrames(int index) const;
+		static bool write(Skeleton& skeleton, std::vector<char>& data);
+		static bool save(Skeleton& skeleton, const std::string& fileName);
+		virtual ~SkeletonAsset(void);
+	};
+}
+#endif
@@ -0,0 +1,66 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef SKALE_SKELETON_BATCH_HPP
+#define SKALE_SKELETON_BATCH_HPP
+#include <vector>
+#include "SKALE/platform.hpp"
+#include "SKALE/ThreadPool.hpp"
+namespace skl
+{
+	class Skeleton;
+	class SkeletonInstance;
+
+	//Updates many skeletons per frame across a ThreadPool.
+	//Every skeleton is handled by exactly one thread and skeletons do not
+	//share state, so the result is identical to updating them serially.
+	class SkeletonBatch
+	{
+		std::vector<Skeleton*> mSkeletons;
+		std::vector<SkeletonInstance*> mInstances;
+		ThreadPool* mPool;
+		size_t mGrainSize;
+		static void _updateSkeletons(size_t first, size_t last, void* userData);
+		static void _updateInstances(size_t first, size_t last, void* userData);
+	public:
+		explicit SkeletonBatch(ThreadPool* pool);
+		void add(Skeleton* skeleton);
+		void add(SkeletonInstance* instance);
+		bool remove(Skeleton* skeleton);
+		bool remove(SkeletonInstance* instance);
+		void clear();
+		int count() const;
+		void setGrainSize(size_t grainSize);
+		size_t getGrainSize() const;
+		void update();
+		virtual ~SkeletonBatch(void);
+	};
+}
+#endif
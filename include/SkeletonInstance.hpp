@@ -0,0 +1,75 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef SKALE_SKELETON_INSTANCE_HPP
+#define SKALE_SKELETON_INSTANCE_HPP
+#include "SKALE/platform.hpp"
+#include "SKALE/Rig.hpp"
+namespace skl
+{
+	//Per entity pose of a shared Rig. Holds only the local and world pose
+	//arrays, in a single allocation. Bone indices are Rig indices.
+	class SkeletonInstance
+	{
+		const Rig* mRig;
+		float* mData;
+		float* _channel(int channel) const;
+	public:
+		explicit SkeletonInstance(const Rig* rig);
+		SkeletonInstance(const SkeletonInstance& other);
+		SkeletonInstance& operator=(const SkeletonInstance& other);
+		const Rig* getRig() const;
+		int count() const;
+		void resetPose();
+		void setPosition(float x, float y);
+		void setAngle(int index, float angle);
+		void setX(int index, float x);
+		void setY(int index, float y);
+		void setLength(int index, float length);
+		float* getX();
+		float* getY();
+		float* getAngle();
+		float* getLength();
+		const float* getX() const;
+		const float* getY() const;
+		const float* getAngle() const;
+		const float* getLength() const;
+		void updateBones();
+		void updateBones(int index);
+		const float& getFrameX(int index) const;
+		const float& getFrameY(int index) const;
+		const float& getFrameAngle(int index) const;
+		const float* getFrameX() const;
+		const float* getFrameY() const;
+		const float* getFrameAngle() const;
+		virtual ~SkeletonInstance(void);
+	};
+}
+#endif
@@ -0,0 +1,96 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef SKALE_SKELETON_JOURNAL_HPP
+#define SKALE_SKELETON_JOURNAL_HPP
+#include <fstream>
+#include <string>
+#include <vector>
+#include "SKALE/platform.hpp"
+namespace skl
+{
+	class Bone;
+	class Skeleton;
+
+	//Append only log of bone edits next to a saved skeleton, in
+	//fileName + ".journal". record() compares every bone with what was
+	//last written and appends only the fields that changed, one line each:
+	//  "name" field value
+	//Once the journal holds enough entries, or bones were added, removed or
+	//renamed, it is compacted into a full save and emptied.
+	//The first line stamps the journal with a hash of the saved file it
+	//applies to. Skeleton::load(fileName) replays it only when the stamp
+	//matches, so a journal left behind by a crash or an older save is
+	//ignored. Skeleton::save removes the journal; record() notices such a
+	//save and checkpoints.
+	class SkeletonJournal
+	{
+		enum Field
+		{
+			FIELD_X,
+			FIELD_Y,
+			FIELD_ANGLE,
+			FIELD_LENGTH,
+			FIELD_MIN_ANGLE,
+			FIELD_MAX_ANGLE,
+			FIELD_RELATIVE,
+			FIELD_FIXTURE,
+			FIELD_COUNT
+		};
+		Skeleton* mSkeleton;
+		std::string mFileName;
+		std::ofstream mJournal;
+		std::vector<const Bone*> mBones;
+		std::vector<std::string> mNames;
+		std::vector<float> mValues; //FIELD_COUNT per bone
+		std::string mBuffer;
+		size_t mEntries;
+		size_t mCompactThreshold;
+		unsigned int mSaveCount;
+		void _snapshot();
+		bool _stamp();
+		void _readFields(const Bone* bone, float* fields) const;
+		bool _isSameHierarchy();
+		SkeletonJournal(const SkeletonJournal&);
+		SkeletonJournal& operator=(const SkeletonJournal&);
+	public:
+		SkeletonJournal(Skeleton* skeleton, const std::string& fileName);
+		static std::string getJournalName(const std::string& fileName);
+		static const char* getFieldName(int field);
+		static std::string getHeader(const char* text, size_t size);
+		bool checkpoint();
+		int record();
+		size_t getEntryCount() const;
+		void setCompactThreshold(size_t entries);
+		size_t getCompactThreshold() const;
+		virtual ~SkeletonJournal(void);
+	};
+}
+#endif
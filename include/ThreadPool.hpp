@@ -0,0 +1,86 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef SKALE_THREAD_POOL_HPP
+#define SKALE_THREAD_POOL_HPP
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include "SKALE/platform.hpp"
+namespace skl
+{
+	//Work stealing pool for data parallel loops. The calling thread takes
+	//part in every parallelFor, so a pool of one thread runs serially.
+	class ThreadPool
+	{
+	public:
+		typedef void (*RangeFunction)(size_t first, size_t last, void* userData);
+	private:
+		struct Range
+		{
+			size_t first;
+			size_t last;
+		};
+		struct WorkQueue
+		{
+			std::mutex lock;
+			std::deque<Range> ranges;
+		};
+
+		std::vector<std::thread> mThreads;
+		std::vector<WorkQueue*> mQueues;
+		std::mutex mLock;
+		std::condition_variable mWake;
+		std::condition_variable mFinished;
+		RangeFunction mFunction;
+		void* mUserData;
+		std::atomic<size_t> mPendingRanges;
+		size_t mActiveWorkers;
+		unsigned int mGeneration;
+		bool mQuit;
+
+		void _workerLoop(size_t queueIndex);
+		bool _popRange(size_t queueIndex, Range& range);
+		void _runRanges(size_t queueIndex);
+		ThreadPool(const ThreadPool&);
+		ThreadPool& operator=(const ThreadPool&);
+	public:
+		explicit ThreadPool(size_t threadCount = 0);
+		size_t getThreadCount() const;
+		size_t getGrainSize(size_t count) const;
+		void parallelFor(size_t count, size_t grainSize,
+			RangeFunction function, void* userData);
+		virtual ~ThreadPool(void);
+	};
+}
+#endif
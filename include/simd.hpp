@@ -0,0 +1,137 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef SKALE_SIMD_HPP
+#define SKALE_SIMD_HPP
+#include "SKALE/platform.hpp"
+
+//Thin wrappers over the widest float vector the compiler targets.
+//SK_SIMD_WIDTH lanes are processed per SkVec. Define SK_NO_SIMD to force
+//the portable scalar version.
+#if !defined(SK_NO_SIMD) && defined(__AVX__)
+	#include <immintrin.h>
+	#define SK_SIMD_WIDTH 8
+#elif !defined(SK_NO_SIMD) && (defined(__SSE__) || defined(_M_X64) || \
+	(defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+	#include <xmmintrin.h>
+	#define SK_SIMD_WIDTH 4
+#else
+	#include <math.h>
+	#define SK_SIMD_WIDTH 4
+	#define SK_SIMD_SCALAR
+#endif
+
+namespace skl
+{
+#if SK_SIMD_WIDTH == 8
+	typedef __m256 SkVec;
+
+	inline SkVec skLoad(const float* p) { return _mm256_loadu_ps(p); }
+	inline void skStore(float* p, SkVec a) { _mm256_storeu_ps(p,a); }
+	inline SkVec skSet(float value) { return _mm256_set1_ps(value); }
+	inline SkVec skAdd(SkVec a, SkVec b) { return _mm256_add_ps(a,b); }
+	inline SkVec skSub(SkVec a, SkVec b) { return _mm256_sub_ps(a,b); }
+	inline SkVec skMul(SkVec a, SkVec b) { return _mm256_mul_ps(a,b); }
+	inline SkVec skDiv(SkVec a, SkVec b) { return _mm256_div_ps(a,b); }
+	inline SkVec skSqrt(SkVec a) { return _mm256_sqrt_ps(a); }
+	inline SkVec skMin(SkVec a, SkVec b) { return _mm256_min_ps(a,b); }
+	inline SkVec skMax(SkVec a, SkVec b) { return _mm256_max_ps(a,b); }
+	inline SkVec skLessEqual(SkVec a, SkVec b) { return _mm256_cmp_ps(a,b,_CMP_LE_OQ); }
+	inline SkVec skAnd(SkVec a, SkVec b) { return _mm256_and_ps(a,b); }
+	inline SkVec skAndNot(SkVec mask, SkVec a) { return _mm256_andnot_ps(mask,a); }
+	inline SkVec skOr(SkVec a, SkVec b) { return _mm256_or_ps(a,b); }
+	inline SkVec skSelect(SkVec mask, SkVec a, SkVec b) { return _mm256_blendv_ps(b,a,mask); }
+	inline int skMoveMask(SkVec mask) { return _mm256_movemask_ps(mask); }
+#elif !defined(SK_SIMD_SCALAR)
+	typedef __m128 SkVec;
+
+	inline SkVec skLoad(const float* p) { return _mm_loadu_ps(p); }
+	inline void skStore(float* p, SkVec a) { _mm_storeu_ps(p,a); }
+	inline SkVec skSet(float value) { return _mm_set1_ps(value); }
+	inline SkVec skAdd(SkVec a, SkVec b) { return _mm_add_ps(a,b); }
+	inline SkVec skSub(SkVec a, SkVec b) { return _mm_sub_ps(a,b); }
+	inline SkVec skMul(SkVec a, SkVec b) { return _mm_mul_ps(a,b); }
+	inline SkVec skDiv(SkVec a, SkVec b) { return _mm_div_ps(a,b); }
+	inline SkVec skSqrt(SkVec a) { return _mm_sqrt_ps(a); }
+	inline SkVec skMin(SkVec a, SkVec b) { return _mm_min_ps(a,b); }
+	inline SkVec skMax(SkVec a, SkVec b) { return _mm_max_ps(a,b); }
+	inline SkVec skLessEqual(SkVec a, SkVec b) { return _mm_cmple_ps(a,b); }
+	inline SkVec skAnd(SkVec a, SkVec b) { return _mm_and_ps(a,b); }
+	inline SkVec skAndNot(SkVec mask, SkVec a) { return _mm_andnot_ps(mask,a); }
+	inline SkVec skOr(SkVec a, SkVec b) { return _mm_or_ps(a,b); }
+	inline SkVec skSelect(SkVec mask, SkVec a, SkVec b)
+	{
+		return _mm_or_ps(_mm_and_ps(mask,a),_mm_andnot_ps(mask,b));
+	}
+	inline int skMoveMask(SkVec mask) { return _mm_movemask_ps(mask); }
+#else
+	//Masks hold 1.0f for true lanes and 0.0f for false lanes
+	struct SkVec
+	{
+		float v[SK_SIMD_WIDTH];
+	};
+
+	#define SK_SIMD_LANES(expr) SkVec r; for(int i = 0; i < SK_SIMD_WIDTH; ++i) { r.v[i] = (expr); } return r;
+
+	inline SkVec skLoad(const float* p) { SK_SIMD_LANES(p[i]) }
+	inline void skStore(float* p, SkVec a) { for(int i = 0; i < SK_SIMD_WIDTH; ++i) { p[i] = a.v[i]; } }
+	inline SkVec skSet(float value) { SK_SIMD_LANES(value) }
+	inline SkVec skAdd(SkVec a, SkVec b) { SK_SIMD_LANES(a.v[i] + b.v[i]) }
+	inline SkVec skSub(SkVec a, SkVec b) { SK_SIMD_LANES(a.v[i] - b.v[i]) }
+	inline SkVec skMul(SkVec a, SkVec b) { SK_SIMD_LANES(a.v[i] * b.v[i]) }
+	inline SkVec skDiv(SkVec a, SkVec b) { SK_SIMD_LANES(a.v[i] / b.v[i]) }
+	inline SkVec skSqrt(SkVec a) { SK_SIMD_LANES(sqrtf(a.v[i])) }
+	inline SkVec skMin(SkVec a, SkVec b) { SK_SIMD_LANES(a.v[i] < b.v[i] ? a.v[i] : b.v[i]) }
+	inline SkVec skMax(SkVec a, SkVec b) { SK_SIMD_LANES(a.v[i] > b.v[i] ? a.v[i] : b.v[i]) }
+	inline SkVec skLessEqual(SkVec a, SkVec b) { SK_SIMD_LANES(a.v[i] <= b.v[i] ? 1.0f : 0.0f) }
+	inline SkVec skAnd(SkVec a, SkVec b) { SK_SIMD_LANES(a.v[i] != 0.0f ? b.v[i] : 0.0f) }
+	inline SkVec skAndNot(SkVec mask, SkVec a) { SK_SIMD_LANES(mask.v[i] != 0.0f ? 0.0f : a.v[i]) }
+	inline SkVec skOr(SkVec a, SkVec b) { SK_SIMD_LANES(a.v[i] != 0.0f ? a.v[i] : b.v[i]) }
+	inline SkVec skSelect(SkVec mask, SkVec a, SkVec b) { SK_SIMD_LANES(mask.v[i] != 0.0f ? a.v[i] : b.v[i]) }
+	inline int skMoveMask(SkVec mask)
+	{
+		int bits = 0;
+		for(int i = 0; i < SK_SIMD_WIDTH; ++i)
+		{
+			if(mask.v[i] != 0.0f)
+			{
+				bits |= 1 << i;
+			}
+		}
+		return bits;
+	}
+
+	#undef SK_SIMD_LANES
+#endif
+
+	//All bits set in every lane, usable as a mask of true lanes
+	inline SkVec skTrue() { return skLessEqual(skSet(0.0f),skSet(0.0f)); }
+}
+#endif
@@ -0,0 +1,257 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "SKALE/AnimationClip.hpp"
+#include "SKALE/Rig.hpp"
+#include "SKALE/Skeleton.hpp"
+#include "SKALE/SkeletonInstance.hpp"
+#include <math.h>
+
+namespace skl
+{
+	AnimationClip::AnimationClip(void)
+		: mLength(0.0f)
+	{
+	}
+
+	AnimationClip::~AnimationClip(void)
+	{
+	}
+
+	bool AnimationClip::build( const Rig& rig, Skeleton& skeleton )
+	{
+		//One angle track per bone that has keyframes
+		clear();
+		for(int i = 0; i < rig.count(); ++i)
+		{
+			Bone* bone = i == 0 ? skeleton.getRoot() : skeleton.getByName(rig.getName(i));
+			if(!bone)
+			{
+				clear();
+				return false;
+			}
+
+			const std::vector<KeyFrame>& keyFrames = bone->getKeyFrames();
+			if(keyFrames.empty())
+			{
+				continue;
+			}
+
+			addTrack(i,CHANNEL_ANGLE);
+			for(size_t k = 0; k < keyFrames.size(); ++k)
+			{
+				addKey((float)keyFrames[k].getFrame(),keyFrames[k].getValue());
+			}
+		}
+		return true;
+	}
+
+	void AnimationClip::clear()
+	{
+		mTracks.clear();
+		mFrames.clear();
+		mValues.clear();
+		mLength = 0.0f;
+	}
+
+	int AnimationClip::addTrack( int bone, Channel channel )
+	{
+		Track track;
+		track.bone = bone;
+		track.channel = channel;
+		track.first = mFrames.size();
+		track.count = 0;
+		mTracks.push_back(track);
+		return (int)mTracks.size() - 1;
+	}
+
+	bool AnimationClip::addKey( float frame, float value )
+	{
+		//Keys go to the last track and must come in frame order
+		if(mTracks.empty())
+		{
+			return false;
+		}
+
+		Track& track = mTracks.back();
+		if(track.count > 0 && frame <= mFrames.back())
+		{
+			return false;
+		}
+
+		mFrames.push_back(frame);
+		mValues.push_back(value);
+		track.count++;
+		if(frame > mLength)
+		{
+			mLength = frame;
+		}
+		return true;
+	}
+
+	size_t AnimationClip::getTrackCount() const
+	{
+		return mTracks.size();
+	}
+
+	int AnimationClip::getTrackBone( size_t track ) const
+	{
+		return mTracks[track].bone;
+	}
+
+	AnimationClip::Channel AnimationClip::getTrackChannel( size_t track ) const
+	{
+		return mTracks[track].channel;
+	}
+
+	size_t AnimationClip::getKeyCount( size_t track ) const
+	{
+		return mTracks[track].count;
+	}
+
+	const float* AnimationClip::getKeyFrames( size_t track ) const
+	{
+		return mTracks[track].count > 0 ? &mFrames[mTracks[track].first] : NULL;
+	}
+
+	const float* AnimationClip::getKeyValues( size_t track ) const
+	{
+		return mTracks[track].count > 0 ? &mValues[mTracks[track].first] : NULL;
+	}
+
+	float AnimationClip::getLength() const
+	{
+		return mLength;
+	}
+
+	size_t AnimationClip::getMemoryUsage() const
+	{
+		return sizeof(AnimationClip) +
+			mTracks.capacity() * sizeof(Track) +
+			mFrames.capacity() * sizeof(float) +
+			mValues.capacity() * sizeof(float);
+	}
+
+	float AnimationClip::_sampleTrack( const Track& track, float frame ) const
+	{
+		const float* frames = &mFrames[track.first];
+		const float* values = &mValues[track.first];
+		size_t last = track.count - 1;
+
+		if(frame <= frames[0])
+		{
+			return values[0];
+		}
+		if(frame >= frames[last])
+		{
+			return values[last];
+		}
+
+		size_t low = 0;
+		size_t high = last;
+		while(low < high)
+		{
+			size_t mid = (low + high) / 2;
+			if(frames[mid] <= frame)
+			{
+				low = mid + 1;
+			}
+			else
+			{
+				high = mid;
+			}
+		}
+
+		float t = (frame - frames[low - 1]) / (frames[low] - frames[low - 1]);
+		float delta = values[low] - values[low - 1];
+
+		//Angles turn the short way around
+		if(track.channel == CHANNEL_ANGLE)
+		{
+			delta = shortestArc(delta);
+		}
+
+		return values[low - 1] + delta * t;
+	}
+
+	void AnimationClip::sample( float frame, float* x, float* y, float* angle, float* length ) const
+	{
+		//Channels without a track keep whatever the arrays already hold
+		for(size_t i = 0; i < mTracks.size(); ++i)
+		{
+			const Track& track = mTracks[i];
+			if(track.count == 0)
+			{
+				continue;
+			}
+
+			float value = _sampleTrack(track,frame);
+			switch(track.channel)
+			{
+			case CHANNEL_X:
+				x[track.bone] = value;
+				break;
+			case CHANNEL_Y:
+				y[track.bone] = value;
+				break;
+			case CHANNEL_ANGLE:
+				angle[track.bone] = value;
+				break;
+			case CHANNEL_LENGTH:
+				length[track.bone] = value;
+				break;
+			}
+		}
+	}
+
+	bool AnimationClip::fitsBoneCount( int boneCount ) const
+	{
+		for(size_t i = 0; i < mTracks.size(); ++i)
+		{
+			if(mTracks[i].bone < 0 || mTracks[i].bone >= boneCount)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool AnimationClip::sample( float frame, SkeletonInstance& instance ) const
+	{
+		//Tracks index the instance's arrays directly
+		if(!fitsBoneCount(instance.count()))
+		{
+			return false;
+		}
+
+		sample(frame,instance.getX(),instance.getY(),instance.getAngle(),instance.getLength());
+		return true;
+	}
+}
@@ -0,0 +1,209 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "SKALE/BakedAnimation.hpp"
+#include "SKALE/KeyFrame.hpp"
+#include "SKALE/AnimationClip.hpp"
+#include "SKALE/Rig.hpp"
+#include "SKALE/SkeletonInstance.hpp"
+#include <math.h>
+#include <string.h>
+
+namespace skl
+{
+	BakedAnimation::BakedAnimation(void)
+		: mBoneCount(0), mRowCount(0), mFrameStep(1.0f), mLength(0.0f), mLooping(true)
+	{
+	}
+
+	BakedAnimation::~BakedAnimation(void)
+	{
+	}
+
+	bool BakedAnimation::bake( const Rig& rig, const AnimationClip& clip, float frameStep )
+	{
+		clear();
+		if(frameStep <= 0.0f || rig.count() == 0 || !clip.fitsBoneCount(rig.count()))
+		{
+			return false;
+		}
+
+		mBoneCount = rig.count();
+		mFrameStep = frameStep;
+		mLength = clip.getLength();
+		mRowCount = (size_t)floor(mLength / frameStep) + 1;
+		if((mRowCount - 1) * frameStep < mLength)
+		{
+			mRowCount++; //A shorter final step ending on the last frame
+		}
+		mTable.resize(mRowCount * mBoneCount * 3);
+
+		//Same FK as SkeletonInstance::updateBones, one row per step
+		SkeletonInstance instance(&rig);
+		size_t rowSize = mBoneCount * sizeof(float);
+		for(size_t row = 0; row < mRowCount; ++row)
+		{
+			instance.resetPose();
+			instance.setPosition(0.0f,0.0f);
+			clip.sample(getRowFrame(row),instance);
+			instance.updateBones();
+
+			float* rowData = &mTable[row * mBoneCount * 3];
+			memcpy(rowData,instance.getFrameX(),rowSize);
+			memcpy(rowData + mBoneCount,instance.getFrameY(),rowSize);
+			memcpy(rowData + mBoneCount * 2,instance.getFrameAngle(),rowSize);
+		}
+
+		return true;
+	}
+
+	void BakedAnimation::clear()
+	{
+		mBoneCount = 0;
+		mRowCount = 0;
+		mLength = 0.0f;
+		mTable.clear();
+	}
+
+	int BakedAnimation::getBoneCount() const
+	{
+		return mBoneCount;
+	}
+
+	size_t BakedAnimation::getRowCount() const
+	{
+		return mRowCount;
+	}
+
+	float BakedAnimation::getFrameStep() const
+	{
+		return mFrameStep;
+	}
+
+	float BakedAnimation::getRowFrame( size_t row ) const
+	{
+		float frame = row * mFrameStep;
+		return frame < mLength ? frame : mLength;
+	}
+
+	float BakedAnimation::getLength() const
+	{
+		return mLength;
+	}
+
+	void BakedAnimation::setLooping( bool looping )
+	{
+		mLooping = looping;
+	}
+
+	bool BakedAnimation::isLooping() const
+	{
+		return mLooping;
+	}
+
+	const float* BakedAnimation::getRowX( size_t row ) const
+	{
+		return &mTable[row * mBoneCount * 3];
+	}
+
+	const float* BakedAnimation::getRowY( size_t row ) const
+	{
+		return &mTable[row * mBoneCount * 3 + mBoneCount];
+	}
+
+	const float* BakedAnimation::getRowAngle( size_t row ) const
+	{
+		return &mTable[row * mBoneCount * 3 + mBoneCount * 2];
+	}
+
+	size_t BakedAnimation::getMemoryUsage() const
+	{
+		return sizeof(BakedAnimation) + mTable.capacity() * sizeof(float);
+	}
+
+	float BakedAnimation::getPlaybackOffset( size_t instance ) const
+	{
+		//Golden ratio steps spread any number of instances evenly over the clip
+		float phase = (float)fmod(instance * 0.6180339887,1.0);
+		return phase * getLength();
+	}
+
+	void BakedAnimation::sample( float frame, float* frameX, float* frameY, float* frameAngle,
+		float x, float y ) const
+	{
+		if(mRowCount == 0)
+		{
+			return;
+		}
+
+		float length = getLength();
+		if(mLooping && length > 0.0f)
+		{
+			frame = fmod(frame,length);
+			if(frame < 0.0f)
+			{
+				frame += length;
+			}
+		}
+		else if(frame < 0.0f)
+		{
+			frame = 0.0f;
+		}
+		else if(frame > length)
+		{
+			frame = length;
+		}
+
+		float position = frame / mFrameStep;
+		size_t row = (size_t)position;
+		if(row >= mRowCount - 1)
+		{
+			row = mRowCount > 1 ? mRowCount - 2 : 0;
+		}
+		size_t next = mRowCount > 1 ? row + 1 : row;
+		float span = getRowFrame(next) - getRowFrame(row);
+		float t = span > 0.0f ? (frame - getRowFrame(row)) / span : 0.0f;
+
+		const float* fromX = getRowX(row);
+		const float* fromY = getRowY(row);
+		const float* fromAngle = getRowAngle(row);
+		const float* toX = getRowX(next);
+		const float* toY = getRowY(next);
+		const float* toAngle = getRowAngle(next);
+		for(int i = 0; i < mBoneCount; ++i)
+		{
+			frameX[i] = x + fromX[i] + (toX[i] - fromX[i]) * t;
+			frameY[i] = y + fromY[i] + (toY[i] - fromY[i]) * t;
+
+			float delta = shortestArc(toAngle[i] - fromAngle[i]);
+			frameAngle[i] = fromAngle[i] + delta * t;
+		}
+	}
+}
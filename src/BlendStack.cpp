@@ -0,0 +1,263 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "SKALE/BlendStack.hpp"
+#include "SKALE/KeyFrame.hpp"
+#include "SKALE/AnimationClip.hpp"
+#include "SKALE/Rig.hpp"
+#include "SKALE/SkeletonInstance.hpp"
+#include <math.h>
+#include <string.h>
+
+namespace skl
+{
+	BlendStack::BlendStack( const Rig* rig )
+		: mRig(rig)
+	{
+	}
+
+	BlendStack::~BlendStack(void)
+	{
+	}
+
+	const Rig* BlendStack::getRig() const
+	{
+		return mRig;
+	}
+
+	bool BlendStack::_isValid( int layer ) const
+	{
+		return layer >= 0 && layer < (int)mLayers.size();
+	}
+
+	int BlendStack::addLayer( const AnimationClip* clip, float weight )
+	{
+		Layer layer;
+		layer.clip = clip;
+		layer.frame = 0.0f;
+		layer.weight = weight;
+		mLayers.push_back(layer);
+		return (int)mLayers.size() - 1;
+	}
+
+	bool BlendStack::removeLayer( int layer )
+	{
+		if(!_isValid(layer))
+		{
+			return false;
+		}
+
+		mLayers.erase(mLayers.begin() + layer);
+		return true;
+	}
+
+	void BlendStack::clear()
+	{
+		mLayers.clear();
+	}
+
+	int BlendStack::count() const
+	{
+		return (int)mLayers.size();
+	}
+
+	void BlendStack::setClip( int layer, const AnimationClip* clip )
+	{
+		if(_isValid(layer))
+		{
+			mLayers[layer].clip = clip;
+		}
+	}
+
+	const AnimationClip* BlendStack::getClip( int layer ) const
+	{
+		return _isValid(layer) ? mLayers[layer].clip : NULL;
+	}
+
+	void BlendStack::setFrame( int layer, float frame )
+	{
+		if(_isValid(layer))
+		{
+			mLayers[layer].frame = frame;
+		}
+	}
+
+	float BlendStack::getFrame( int layer ) const
+	{
+		return _isValid(layer) ? mLayers[layer].frame : 0.0f;
+	}
+
+	void BlendStack::setWeight( int layer, float weight )
+	{
+		if(_isValid(layer))
+		{
+			mLayers[layer].weight = weight;
+		}
+	}
+
+	float BlendStack::getWeight( int layer ) const
+	{
+		return _isValid(layer) ? mLayers[layer].weight : 0.0f;
+	}
+
+	void BlendStack::setMask( int layer, int bone, float weight )
+	{
+		if(!_isValid(layer) || bone < 0 || bone >= mRig->count())
+		{
+			return;
+		}
+
+		std::vector<float>& mask = mLayers[layer].mask;
+		if(mask.empty())
+		{
+			mask.assign(mRig->count(),1.0f);
+		}
+		mask[bone] = weight;
+	}
+
+	void BlendStack::setMaskSubtree( int layer, int bone, float weight )
+	{
+		if(!_isValid(layer) || bone < 0 || bone >= mRig->count())
+		{
+			return;
+		}
+
+		for(int i = bone; i < mRig->getSubtreeEnd(bone); ++i)
+		{
+			setMask(layer,i,weight);
+		}
+	}
+
+	void BlendStack::clearMask( int layer )
+	{
+		if(_isValid(layer))
+		{
+			mLayers[layer].mask.clear();
+		}
+	}
+
+	float BlendStack::getMask( int layer, int bone ) const
+	{
+		if(!_isValid(layer) || bone < 0 || bone >= mRig->count())
+		{
+			return 0.0f;
+		}
+
+		const std::vector<float>& mask = mLayers[layer].mask;
+		return mask.empty() ? 1.0f : mask[bone];
+	}
+
+	size_t BlendStack::getArenaSize() const
+	{
+		return (size_t)mRig->count() * 4;
+	}
+
+	bool BlendStack::evaluate( SkeletonInstance& instance )
+	{
+		mArena.reset();
+		mArena.reserve(getArenaSize());
+		return evaluate(instance,mArena);
+	}
+
+	bool BlendStack::evaluate( SkeletonInstance& instance, PoseArena& arena ) const
+	{
+		//The blend writes n bones into the instance, so it must share the rig
+		if(instance.getRig() != mRig)
+		{
+			return false;
+		}
+
+		for(size_t l = 0; l < mLayers.size(); ++l)
+		{
+			if(mLayers[l].clip && !mLayers[l].clip->fitsBoneCount(mRig->count()))
+			{
+				return false;
+			}
+		}
+
+		//The temporary pose is carved from the arena, false when it is full
+		int n = mRig->count();
+		float* pose = arena.allocate(getArenaSize());
+		if(!pose)
+		{
+			return false;
+		}
+
+		float* poseX = pose;
+		float* poseY = pose + n;
+		float* poseAngle = pose + n * 2;
+		float* poseLength = pose + n * 3;
+
+		float* x = instance.getX();
+		float* y = instance.getY();
+		float* angle = instance.getAngle();
+		float* length = instance.getLength();
+
+		for(size_t l = 0; l < mLayers.size(); ++l)
+		{
+			const Layer& layer = mLayers[l];
+			if(!layer.clip || layer.weight <= 0.0f)
+			{
+				continue;
+			}
+
+			//Start from the result so far so untracked channels blend to themselves
+			memcpy(poseX,x,n * sizeof(float));
+			memcpy(poseY,y,n * sizeof(float));
+			memcpy(poseAngle,angle,n * sizeof(float));
+			memcpy(poseLength,length,n * sizeof(float));
+			layer.clip->sample(layer.frame,poseX,poseY,poseAngle,poseLength);
+
+			const float* mask = layer.mask.empty() ? NULL : &layer.mask[0];
+			for(int i = 0; i < n; ++i)
+			{
+				float w = mask ? layer.weight * mask[i] : layer.weight;
+				if(w <= 0.0f)
+				{
+					continue;
+				}
+				if(w > 1.0f)
+				{
+					w = 1.0f;
+				}
+
+				x[i] += (poseX[i] - x[i]) * w;
+				y[i] += (poseY[i] - y[i]) * w;
+				length[i] += (poseLength[i] - length[i]) * w;
+
+				//Shortest way around for angles
+				float delta = shortestArc(poseAngle[i] - angle[i]);
+				angle[i] += delta * w;
+			}
+		}
+
+		return true;
+	}
+}
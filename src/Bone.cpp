@@ -47,7 +47,8 @@ namespace skl
 		mFrameX(0),mFrameY(0),mFrameAngle(0),mParent(parent),
 		currentFrame(0),currentKeyFrameIndex(0),startKeyFrame(NULL),
 		endKeyFrame(NULL),framesPerSecond(60),curIncreaseAngle(0.0f),
-		remainingInterpolationFrames(0),mFixture(false)
+		remainingInterpolationFrames(0),mFixture(false),
+		mDirty(true),mDirtyChildren(false),mId()
 	{
 		mMinAngle = fmod(mMinAngle,SK_TWO_PI);
 		mMaxAngle = fmod(mMaxAngle,SK_TWO_PI);
@@ -56,21 +57,19 @@ namespace skl
 
 	bool Bone::remove( Bone* child )
 	{
-		for(std::list<Bone>::iterator it = children.begin(); it != children.end(); ++it)
+		if(!child || child->mParent != this)
 		{
-			if(&(*it) == child)
-			{
-				children.erase(it);
-				return true;
-			}
+			return false;
 		}
 
-		return false;
+		children.erase(child->mSelf);
+		return true;
 	}
 
 	void Bone::setAngle( float angle )
 	{
 		mAngle = angle;
+		markDirty();
 	}
 
 	const float& Bone::getAngle() const
@@ -81,17 +80,20 @@ namespace skl
 	void Bone::setX( float x )
 	{
 		mX = x;
+		markDirty();
 	}
 
 	void Bone::setY( float y )
 	{
 		mY = y;
+		markDirty();
 	}
 
 	void Bone::set( float x, float y )
 	{
 		mX = x;
 		mY = y;
+		markDirty();
 	}
 
 	void Bone::set( float x, float y, float angle )
@@ -130,9 +132,46 @@ namespace skl
 		return mMaxAngle;
 	}
 
+	bool Bone::hasAngleLimits() const
+	{
+		//Limits spanning the whole circle (0 to 6.28 in the sample data)
+		//do not restrict anything
+		return mMaxAngle - mMinAngle < SK_TWO_PI - 0.01f;
+	}
+
+	float Bone::constrainAngle( float angle ) const
+	{
+		if(!hasAngleLimits())
+		{
+			return angle;
+		}
+
+		//Measure the angle along the circle from the minimum angle
+		float range = mMaxAngle - mMinAngle;
+		float offset = fmod(angle - mMinAngle,SK_TWO_PI);
+		if(offset < 0.0f)
+		{
+			offset += SK_TWO_PI;
+		}
+
+		if(offset <= range)
+		{
+			return angle;
+		}
+
+		//Outside the allowed arc, snap to the nearest limit
+		if(offset - range < SK_TWO_PI - offset)
+		{
+			return mMaxAngle;
+		}
+
+		return mMinAngle;
+	}
+
 	void Bone::setLength( float length )
 	{
 		mLength = abs(length);
+		markDirty();
 	}
 
 	void Bone::clear()
@@ -143,6 +182,7 @@ namespace skl
 	void Bone::setRelative( bool relative )
 	{
 		mRelative = relative;
+		markDirty();
 	}
 
 	bool Bone::isRelative() const
@@ -156,6 +196,8 @@ namespace skl
 	{
 		children.push_back(Bone(x,y,angle,length
 			,minAngle,maxAngle,true,name,this));
+		children.back().mSelf = --children.end();
+		children.back().markDirty();
 		return &children.back();
 	}
 
@@ -169,6 +211,16 @@ namespace skl
 		return children.end();
 	}
 
+	std::list<Bone>::const_iterator Bone::begin() const
+	{
+		return children.begin();
+	}
+
+	std::list<Bone>::const_iterator Bone::end() const
+	{
+		return children.end();
+	}
+
 	Bone* Bone::getParent() const
 	{
 		return mParent;
@@ -329,6 +381,66 @@ namespace skl
 		currentFrame++;
 	}
 
+	const std::vector<KeyFrame>& Bone::getKeyFrames() const
+	{
+		return mKeyFrames;
+	}
+
+	void Bone::sampleAnimation( float frame )
+	{
+		//Unlike processAnimation this keeps no cursor, any frame can be asked for
+		if(mKeyFrames.size() == 0)
+		{
+			return;
+		}
+		setAngle(sampleKeyFrames(mKeyFrames,frame));
+	}
+
+	KeyFrameReduction Bone::reduceKeyFrames( float tolerance )
+	{
+		//The cursor points into the old keys, restart the animation
+		KeyFrameReduction reduction = ::reduceKeyFrames(mKeyFrames,tolerance);
+		resetAnimation();
+		return reduction;
+	}
+
+	void Bone::markDirty()
+	{
+		mDirty = true;
+
+		//Flag the path to the root so updates can skip clean branches
+		for(Bone* bone = mParent; bone && !bone->mDirtyChildren; bone = bone->mParent)
+		{
+			bone->mDirtyChildren = true;
+		}
+	}
+
+	void Bone::clearDirty()
+	{
+		mDirty = false;
+		mDirtyChildren = false;
+	}
+
+	bool Bone::isDirty() const
+	{
+		return mDirty;
+	}
+
+	bool Bone::hasDirtyChildren() const
+	{
+		return mDirtyChildren;
+	}
+
+	void Bone::setId( BoneId id )
+	{
+		mId = id;
+	}
+
+	BoneId Bone::getId() const
+	{
+		return mId;
+	}
+
 	void Bone::setAsFixture( bool fixture )
 	{
 		mFixture = fixture;
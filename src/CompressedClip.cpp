@@ -0,0 +1,277 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "SKALE/CompressedClip.hpp"
+#include "SKALE/KeyFrame.hpp"
+#include "SKALE/SkeletonInstance.hpp"
+#include <math.h>
+#include <algorithm>
+
+#define SK_KEY_BLOCK 16
+
+namespace skl
+{
+	CompressedClip::CompressedClip(void)
+		: mLength(0.0f), mErrorBound(0.0f)
+	{
+	}
+
+	CompressedClip::~CompressedClip(void)
+	{
+	}
+
+	void CompressedClip::clear()
+	{
+		mTracks.clear();
+		mValues.clear();
+		mDeltas.clear();
+		mBlockFrames.clear();
+		mLength = 0.0f;
+		mErrorBound = 0.0f;
+	}
+
+	bool CompressedClip::compress( const AnimationClip& clip, float constantTolerance )
+	{
+		//Frames must be whole and at most 65535 apart to fit the deltas
+		clear();
+		std::vector<float> values;
+		for(size_t i = 0; i < clip.getTrackCount(); ++i)
+		{
+			size_t count = clip.getKeyCount(i);
+			if(count == 0)
+			{
+				continue;
+			}
+
+			const float* frames = clip.getKeyFrames(i);
+			values.assign(clip.getKeyValues(i),clip.getKeyValues(i) + count);
+
+			//Unwrap angles so plain interpolation takes the short way around
+			if(clip.getTrackChannel(i) == AnimationClip::CHANNEL_ANGLE)
+			{
+				for(size_t k = 1; k < count; ++k)
+				{
+					float delta = shortestArc(values[k] - values[k - 1]);
+					values[k] = values[k - 1] + delta;
+				}
+			}
+
+			float minValue = values[0];
+			float maxValue = values[0];
+			for(size_t k = 1; k < count; ++k)
+			{
+				minValue = values[k] < minValue ? values[k] : minValue;
+				maxValue = values[k] > maxValue ? values[k] : maxValue;
+			}
+
+			Track track;
+			track.bone = clip.getTrackBone(i);
+			track.channel = clip.getTrackChannel(i);
+			track.lastFrame = frames[count - 1];
+			track.firstKey = mValues.size();
+			track.firstBlock = mBlockFrames.size();
+
+			if(maxValue - minValue <= constantTolerance)
+			{
+				track.minValue = (minValue + maxValue) * 0.5f;
+				track.scale = 0.0f;
+				track.keyCount = 1;
+				mErrorBound = std::max(mErrorBound,(maxValue - minValue) * 0.5f);
+			}
+			else
+			{
+				track.minValue = minValue;
+				track.scale = (maxValue - minValue) / 65535.0f;
+				track.keyCount = count;
+				mErrorBound = std::max(mErrorBound,track.scale * 0.5f);
+
+				for(size_t k = 0; k < count; ++k)
+				{
+					if(frames[k] < 0.0f || frames[k] != floor(frames[k]) ||
+						(k > 0 && frames[k] - frames[k - 1] > 65535.0f))
+					{
+						clear();
+						return false;
+					}
+
+					mValues.push_back((unsigned short)floor((values[k] - minValue) / track.scale + 0.5f));
+					if(k % SK_KEY_BLOCK == 0)
+					{
+						mBlockFrames.push_back((unsigned int)frames[k]);
+						mDeltas.push_back(0);
+					}
+					else
+					{
+						mDeltas.push_back((unsigned short)(frames[k] - frames[k - 1]));
+					}
+				}
+			}
+
+			mTracks.push_back(track);
+			mLength = std::max(mLength,track.lastFrame);
+		}
+
+		//Drop the slack left by push_back
+		std::vector<Track>(mTracks).swap(mTracks);
+		std::vector<unsigned short>(mValues).swap(mValues);
+		std::vector<unsigned short>(mDeltas).swap(mDeltas);
+		std::vector<unsigned int>(mBlockFrames).swap(mBlockFrames);
+		return true;
+	}
+
+	size_t CompressedClip::getTrackCount() const
+	{
+		return mTracks.size();
+	}
+
+	float CompressedClip::getLength() const
+	{
+		return mLength;
+	}
+
+	float CompressedClip::getErrorBound() const
+	{
+		return mErrorBound;
+	}
+
+	size_t CompressedClip::getMemoryUsage() const
+	{
+		return sizeof(CompressedClip) +
+			mTracks.capacity() * sizeof(Track) +
+			mValues.capacity() * sizeof(unsigned short) +
+			mDeltas.capacity() * sizeof(unsigned short) +
+			mBlockFrames.capacity() * sizeof(unsigned int);
+	}
+
+	float CompressedClip::_sampleTrack( const Track& track, float frame ) const
+	{
+		if(track.keyCount == 1)
+		{
+			return track.minValue;
+		}
+
+		const unsigned short* values = &mValues[track.firstKey];
+		const unsigned short* deltas = &mDeltas[track.firstKey];
+		const unsigned int* blockFrames = &mBlockFrames[track.firstBlock];
+
+		if(frame <= (float)blockFrames[0])
+		{
+			return track.minValue + values[0] * track.scale;
+		}
+		if(frame >= track.lastFrame)
+		{
+			return track.minValue + values[track.keyCount - 1] * track.scale;
+		}
+
+		//Binary search the block index, then walk the deltas in the block
+		size_t low = 0;
+		size_t high = (track.keyCount - 1) / SK_KEY_BLOCK;
+		while(low < high)
+		{
+			size_t mid = (low + high + 1) / 2;
+			if((float)blockFrames[mid] <= frame)
+			{
+				low = mid;
+			}
+			else
+			{
+				high = mid - 1;
+			}
+		}
+
+		size_t key = low * SK_KEY_BLOCK;
+		float start = (float)blockFrames[low];
+		float end = start;
+		while(true)
+		{
+			end = (key + 1) % SK_KEY_BLOCK == 0 ?
+				(float)blockFrames[(key + 1) / SK_KEY_BLOCK] : start + deltas[key + 1];
+			if(end > frame)
+			{
+				break;
+			}
+			start = end;
+			key++;
+		}
+
+		float t = (frame - start) / (end - start);
+		float from = (float)values[key];
+		float to = (float)values[key + 1];
+		return track.minValue + (from + (to - from) * t) * track.scale;
+	}
+
+	void CompressedClip::sample( float frame, float* x, float* y, float* angle, float* length ) const
+	{
+		for(size_t i = 0; i < mTracks.size(); ++i)
+		{
+			const Track& track = mTracks[i];
+			float value = _sampleTrack(track,frame);
+			switch(track.channel)
+			{
+			case AnimationClip::CHANNEL_X:
+				x[track.bone] = value;
+				break;
+			case AnimationClip::CHANNEL_Y:
+				y[track.bone] = value;
+				break;
+			case AnimationClip::CHANNEL_ANGLE:
+				angle[track.bone] = value;
+				break;
+			case AnimationClip::CHANNEL_LENGTH:
+				length[track.bone] = value;
+				break;
+			}
+		}
+	}
+
+	bool CompressedClip::fitsBoneCount( int boneCount ) const
+	{
+		for(size_t i = 0; i < mTracks.size(); ++i)
+		{
+			if(mTracks[i].bone < 0 || mTracks[i].bone >= boneCount)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool CompressedClip::sample( float frame, SkeletonInstance& instance ) const
+	{
+		//Tracks index the instance's arrays directly
+		if(!fitsBoneCount(instance.count()))
+		{
+			return false;
+		}
+
+		sample(frame,instance.getX(),instance.getY(),instance.getAngle(),instance.getLength());
+		return true;
+	}
+}
@@ -0,0 +1,277 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "SKALE/CurveClip.hpp"
+#include "SKALE/KeyFrame.hpp"
+#include "SKALE/SkeletonInstance.hpp"
+#include "SKALE/simd.hpp"
+#include <math.h>
+
+namespace skl
+{
+	CurveClip::CurveClip(void)
+		: mLength(0.0f)
+	{
+	}
+
+	CurveClip::~CurveClip(void)
+	{
+	}
+
+	bool CurveClip::build( const AnimationClip& clip )
+	{
+		//Catmull-Rom slopes through the linear keys of the source clip
+		clear();
+		std::vector<float> values;
+		for(size_t i = 0; i < clip.getTrackCount(); ++i)
+		{
+			size_t count = clip.getKeyCount(i);
+			if(count == 0)
+			{
+				continue;
+			}
+
+			const float* frames = clip.getKeyFrames(i);
+			values.assign(clip.getKeyValues(i),clip.getKeyValues(i) + count);
+			if(clip.getTrackChannel(i) == AnimationClip::CHANNEL_ANGLE)
+			{
+				for(size_t k = 1; k < count; ++k)
+				{
+					float delta = shortestArc(values[k] - values[k - 1]);
+					values[k] = values[k - 1] + delta;
+				}
+			}
+
+			addTrack(clip.getTrackBone(i),clip.getTrackChannel(i));
+			for(size_t k = 0; k < count; ++k)
+			{
+				size_t before = k > 0 ? k - 1 : k;
+				size_t after = k + 1 < count ? k + 1 : k;
+				float slope = after != before ?
+					(values[after] - values[before]) / (frames[after] - frames[before]) : 0.0f;
+				if(!addKey(frames[k],values[k],slope,slope))
+				{
+					clear();
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	void CurveClip::clear()
+	{
+		mTracks.clear();
+		mFrames.clear();
+		mValues.clear();
+		mOutSlopes.clear();
+		mA.clear();
+		mB.clear();
+		mC.clear();
+		mD.clear();
+		mLength = 0.0f;
+	}
+
+	int CurveClip::addTrack( int bone, AnimationClip::Channel channel )
+	{
+		Track track;
+		track.bone = bone;
+		track.channel = channel;
+		track.first = mFrames.size();
+		track.count = 0;
+		mTracks.push_back(track);
+		return (int)mTracks.size() - 1;
+	}
+
+	bool CurveClip::addKey( float frame, float value, float inSlope, float outSlope )
+	{
+		//Keys go to the last track and must come in frame order
+		if(mTracks.empty())
+		{
+			return false;
+		}
+
+		Track& track = mTracks.back();
+		if(track.count > 0)
+		{
+			size_t previous = mFrames.size() - 1;
+			float p0 = mValues[previous];
+			if(frame <= mFrames[previous])
+			{
+				return false;
+			}
+
+			if(track.channel == AnimationClip::CHANNEL_ANGLE)
+			{
+				float delta = shortestArc(value - p0);
+				value = p0 + delta;
+			}
+
+			//The previous key held its value until now, make it a segment
+			float d = frame - mFrames[previous];
+			float m0 = mOutSlopes[previous];
+			float m1 = inSlope;
+			mA[previous] = 2.0f * (p0 - value) / (d * d * d) + (m0 + m1) / (d * d);
+			mB[previous] = 3.0f * (value - p0) / (d * d) - (2.0f * m0 + m1) / d;
+			mC[previous] = m0;
+			mD[previous] = p0;
+		}
+
+		//The last key is flat so frames past the end hold its value
+		mFrames.push_back(frame);
+		mValues.push_back(value);
+		mOutSlopes.push_back(outSlope);
+		mA.push_back(0.0f);
+		mB.push_back(0.0f);
+		mC.push_back(0.0f);
+		mD.push_back(value);
+		track.count++;
+		if(frame > mLength)
+		{
+			mLength = frame;
+		}
+		return true;
+	}
+
+	size_t CurveClip::getTrackCount() const
+	{
+		return mTracks.size();
+	}
+
+	size_t CurveClip::getKeyCount( size_t track ) const
+	{
+		return mTracks[track].count;
+	}
+
+	float CurveClip::getLength() const
+	{
+		return mLength;
+	}
+
+	size_t CurveClip::_findKey( const Track& track, float frame ) const
+	{
+		//Last key at or before frame, the first key for frames before it
+		const float* frames = &mFrames[track.first];
+		size_t low = 0;
+		size_t high = track.count - 1;
+		while(low < high)
+		{
+			size_t mid = (low + high + 1) / 2;
+			if(frames[mid] <= frame)
+			{
+				low = mid;
+			}
+			else
+			{
+				high = mid - 1;
+			}
+		}
+		return track.first + low;
+	}
+
+	void CurveClip::sample( float frame, float* x, float* y, float* angle, float* length ) const
+	{
+		const int W = SK_SIMD_WIDTH;
+		float s[SK_SIMD_WIDTH];
+		float a[SK_SIMD_WIDTH];
+		float b[SK_SIMD_WIDTH];
+		float c[SK_SIMD_WIDTH];
+		float d[SK_SIMD_WIDTH];
+		float result[SK_SIMD_WIDTH];
+		float* channels[4] = {x,y,angle,length};
+
+		size_t first = 0;
+		while(first < mTracks.size())
+		{
+			//Gather the segment of up to W tracks into lanes
+			int lanes = 0;
+			size_t tracks[SK_SIMD_WIDTH];
+			while(lanes < W && first < mTracks.size())
+			{
+				const Track& track = mTracks[first];
+				if(track.count > 0)
+				{
+					size_t key = _findKey(track,frame);
+					float offset = frame - mFrames[key];
+					s[lanes] = offset > 0.0f ? offset : 0.0f;
+					a[lanes] = mA[key];
+					b[lanes] = mB[key];
+					c[lanes] = mC[key];
+					d[lanes] = mD[key];
+					tracks[lanes] = first;
+					lanes++;
+				}
+				first++;
+			}
+
+			for(int l = lanes; l < W; ++l)
+			{
+				s[l] = a[l] = b[l] = c[l] = d[l] = 0.0f;
+			}
+
+			SkVec time = skLoad(s);
+			SkVec value = skAdd(skMul(skLoad(a),time),skLoad(b));
+			value = skAdd(skMul(value,time),skLoad(c));
+			value = skAdd(skMul(value,time),skLoad(d));
+			skStore(result,value);
+
+			for(int l = 0; l < lanes; ++l)
+			{
+				const Track& track = mTracks[tracks[l]];
+				channels[track.channel][track.bone] = result[l];
+			}
+		}
+	}
+
+	bool CurveClip::fitsBoneCount( int boneCount ) const
+	{
+		for(size_t i = 0; i < mTracks.size(); ++i)
+		{
+			if(mTracks[i].bone < 0 || mTracks[i].bone >= boneCount)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool CurveClip::sample( float frame, SkeletonInstance& instance ) const
+	{
+		//Tracks index the instance's arrays directly
+		if(!fitsBoneCount(instance.count()))
+		{
+			return false;
+		}
+
+		sample(frame,instance.getX(),instance.getY(),instance.getAngle(),instance.getLength());
+		return true;
+	}
+}
@@ -0,0 +1,177 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "SKALE/FixedTimestep.hpp"
+#include "SKALE/KeyFrame.hpp"
+#include "SKALE/Skeleton.hpp"
+#include <math.h>
+
+namespace skl
+{
+	FixedTimestep::FixedTimestep( Skeleton* skeleton, float step )
+		: mSkeleton(skeleton), mStep(step), mFramesPerSecond(60.0f),
+		mAccumulator(0.0f), mTime(0.0f), mMaxTicks(5),
+		mTickFunction(NULL), mUserData(NULL)
+	{
+		mSkeleton->updateBones();
+		_capture();
+		mPrevious = mCurrent;
+	}
+
+	FixedTimestep::~FixedTimestep(void)
+	{
+	}
+
+	void FixedTimestep::setTickFunction( TickFunction function, void* userData )
+	{
+		mTickFunction = function;
+		mUserData = userData;
+	}
+
+	void FixedTimestep::setStep( float step )
+	{
+		mStep = step;
+	}
+
+	float FixedTimestep::getStep() const
+	{
+		return mStep;
+	}
+
+	void FixedTimestep::setFramesPerSecond( float framesPerSecond )
+	{
+		mFramesPerSecond = framesPerSecond;
+	}
+
+	float FixedTimestep::getFramesPerSecond() const
+	{
+		return mFramesPerSecond;
+	}
+
+	void FixedTimestep::setMaxTicks( size_t ticks )
+	{
+		mMaxTicks = ticks;
+	}
+
+	size_t FixedTimestep::getMaxTicks() const
+	{
+		return mMaxTicks;
+	}
+
+	void FixedTimestep::setTime( float time )
+	{
+		mTime = time;
+	}
+
+	float FixedTimestep::getTime() const
+	{
+		return mTime;
+	}
+
+	void FixedTimestep::_capture()
+	{
+		const FlatSkeleton& flat = mSkeleton->getFlatBones();
+		int n = flat.count();
+		mCurrent.resize(n * 3);
+		for(int i = 0; i < n; ++i)
+		{
+			const Bone* bone = flat.getBone(i);
+			mCurrent[i] = bone->getFrameX();
+			mCurrent[n + i] = bone->getFrameY();
+			mCurrent[n * 2 + i] = bone->getFrameAngle();
+		}
+	}
+
+	int FixedTimestep::advance( float dt )
+	{
+		mAccumulator += dt;
+		int ticks = 0;
+		while(mAccumulator >= mStep)
+		{
+			//Past the limit the simulation falls behind instead of spiraling
+			if(ticks >= (int)mMaxTicks)
+			{
+				mAccumulator = 0.0f;
+				break;
+			}
+
+			mAccumulator -= mStep;
+			mTime += mStep;
+			mPrevious.swap(mCurrent);
+
+			mSkeleton->sampleAnimation(mTime,mFramesPerSecond);
+			if(mTickFunction)
+			{
+				mTickFunction(mSkeleton,mStep,mUserData);
+			}
+			mSkeleton->updateBones();
+			_capture();
+
+			//Bones were added or removed, nothing to blend from
+			if(mPrevious.size() != mCurrent.size())
+			{
+				mPrevious = mCurrent;
+			}
+			ticks++;
+		}
+
+		return ticks;
+	}
+
+	float FixedTimestep::getAlpha() const
+	{
+		return mStep > 0.0f ? mAccumulator / mStep : 1.0f;
+	}
+
+	int FixedTimestep::count() const
+	{
+		return (int)mCurrent.size() / 3;
+	}
+
+	void FixedTimestep::interpolatedFrame( float alpha, float* frameX, float* frameY, float* frameAngle ) const
+	{
+		for(int i = 0; i < count(); ++i)
+		{
+			interpolatedFrame(i,alpha,frameX[i],frameY[i],frameAngle[i]);
+		}
+	}
+
+	void FixedTimestep::interpolatedFrame( int index, float alpha,
+		float& frameX, float& frameY, float& frameAngle ) const
+	{
+		int n = count();
+		frameX = mPrevious[index] + (mCurrent[index] - mPrevious[index]) * alpha;
+		frameY = mPrevious[n + index] + (mCurrent[n + index] - mPrevious[n + index]) * alpha;
+
+		float from = mPrevious[n * 2 + index];
+		float delta = shortestArc(mCurrent[n * 2 + index] - from);
+		frameAngle = from + delta * alpha;
+	}
+}
@@ -0,0 +1,141 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "SKALE/FlatSkeleton.hpp"
+#include <math.h>
+
+namespace skl
+{
+	void updateFrames( const int* parents, const unsigned char* relative,
+		const float* x, const float* y, const float* angle, const float* length,
+		float* frameX, float* frameY, float* frameAngle, int first, int last )
+	{
+		for(int i = first; i < last; ++i)
+		{
+			float realStartX = 0.0f;
+			float realStartY = 0.0f;
+			float realStartAngle = 0.0f;
+			int parent = parents[i];
+
+			if(relative[i] && parent >= 0)
+			{
+				realStartX = frameX[parent];
+				realStartY = frameY[parent];
+
+				//Children see the parent angle wrapped into [-PI, PI]
+				realStartAngle = fmod(frameAngle[parent],SK_TWO_PI);
+				if( realStartAngle < -SK_PI)
+					realStartAngle += (SK_TWO_PI);
+				else if( realStartAngle > SK_PI)
+					realStartAngle -= (SK_TWO_PI);
+			}
+
+			realStartX += x[i];
+			realStartY += y[i];
+			realStartAngle += angle[i];
+
+			frameX[i] = realStartX + (cos(realStartAngle) * length[i]);
+			frameY[i] = realStartY + (sin(realStartAngle) * length[i]);
+			frameAngle[i] = realStartAngle;
+		}
+	}
+
+	FlatSkeleton::FlatSkeleton(void)
+	{
+	}
+
+	FlatSkeleton::~FlatSkeleton(void)
+	{
+	}
+
+	void FlatSkeleton::build( Bone* root )
+	{
+		clear();
+		if(root)
+		{
+			_addBone(root,-1);
+		}
+	}
+
+	void FlatSkeleton::_addBone( Bone* bone, int parent )
+	{
+		int index = (int)mBones.size();
+		mBones.push_back(bone);
+		mParents.push_back(parent);
+		mSubtreeEnds.push_back(index + 1);
+
+		for(std::list<Bone>::iterator it = bone->begin(); it != bone->end(); ++it)
+		{
+			_addBone(&(*it),index);
+		}
+
+		mSubtreeEnds[index] = (int)mBones.size();
+	}
+
+	void FlatSkeleton::clear()
+	{
+		mBones.clear();
+		mParents.clear();
+		mSubtreeEnds.clear();
+	}
+
+	int FlatSkeleton::count() const
+	{
+		return (int)mBones.size();
+	}
+
+	int FlatSkeleton::indexOf( const Bone* bone ) const
+	{
+		for(int i = 0; i < (int)mBones.size(); ++i)
+		{
+			if(mBones[i] == bone)
+			{
+				return i;
+			}
+		}
+
+		return -1;
+	}
+
+	Bone* FlatSkeleton::getBone( int index ) const
+	{
+		return mBones[index];
+	}
+
+	int FlatSkeleton::getParentIndex( int index ) const
+	{
+		return mParents[index];
+	}
+
+	int FlatSkeleton::getSubtreeEnd( int index ) const
+	{
+		return mSubtreeEnds[index];
+	}
+}
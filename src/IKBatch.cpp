@@ -0,0 +1,200 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "SKALE/IKBatch.hpp"
+#include "SKALE/Skeleton.hpp"
+#include <map>
+
+namespace skl
+{
+	IKBatch::IKBatch( ThreadPool* pool )
+		: mPool(pool), mGroupsValid(false)
+	{
+	}
+
+	IKBatch::~IKBatch(void)
+	{
+	}
+
+	IKSolver& IKBatch::getSolver()
+	{
+		return mSolver;
+	}
+
+	int IKBatch::add( Skeleton* skeleton, Bone* effector, float targetX, float targetY )
+	{
+		if(!skeleton || !effector || skeleton->getBone(effector->getId()) != effector)
+		{
+			return -1;
+		}
+
+		IKJob job;
+		job.skeleton = skeleton;
+		job.effector = effector->getId();
+		job.targetX = targetX;
+		job.targetY = targetY;
+		mJobs.push_back(job);
+
+		IKResult result;
+		result.solved = false;
+		result.iterations = 0;
+		mResults.push_back(result);
+
+		mGroupsValid = false;
+		return (int)mJobs.size() - 1;
+	}
+
+	int IKBatch::add( Skeleton* skeleton, const std::string& boneName, float targetX, float targetY )
+	{
+		if(!skeleton)
+		{
+			return -1;
+		}
+
+		return add(skeleton,skeleton->getByName(boneName),targetX,targetY);
+	}
+
+	int IKBatch::add( Skeleton* skeleton, BoneId bone, float targetX, float targetY )
+	{
+		if(!skeleton)
+		{
+			return -1;
+		}
+
+		return add(skeleton,skeleton->getBone(bone),targetX,targetY);
+	}
+
+	void IKBatch::setTarget( int job, float targetX, float targetY )
+	{
+		mJobs[job].targetX = targetX;
+		mJobs[job].targetY = targetY;
+	}
+
+	const IKJob& IKBatch::getJob( int job ) const
+	{
+		return mJobs[job];
+	}
+
+	void IKBatch::clear()
+	{
+		mJobs.clear();
+		mResults.clear();
+		mGroupedJobs.clear();
+		mGroupStarts.clear();
+		mGroupSolvers.clear();
+		mGroupsValid = false;
+	}
+
+	int IKBatch::count() const
+	{
+		return (int)mJobs.size();
+	}
+
+	void IKBatch::_buildGroups()
+	{
+		//Group jobs by skeleton, keeping the order they were added in
+		std::map<Skeleton*,size_t> groupOfSkeleton;
+		std::vector<std::vector<size_t> > groups;
+		for(size_t i = 0; i < mJobs.size(); ++i)
+		{
+			std::map<Skeleton*,size_t>::iterator it = groupOfSkeleton.find(mJobs[i].skeleton);
+			if(it == groupOfSkeleton.end())
+			{
+				it = groupOfSkeleton.insert(std::make_pair(mJobs[i].skeleton,groups.size())).first;
+				groups.push_back(std::vector<size_t>());
+			}
+			groups[it->second].push_back(i);
+		}
+
+		mGroupedJobs.clear();
+		mGroupStarts.clear();
+		for(size_t i = 0; i < groups.size(); ++i)
+		{
+			mGroupStarts.push_back(mGroupedJobs.size());
+			mGroupedJobs.insert(mGroupedJobs.end(),groups[i].begin(),groups[i].end());
+		}
+		mGroupStarts.push_back(mGroupedJobs.size());
+
+		//Groups keep their order as jobs are appended, so existing
+		//solvers stay with their skeleton
+		mGroupSolvers.resize(groups.size());
+		mGroupsValid = true;
+	}
+
+	void IKBatch::solve()
+	{
+		if(!mGroupsValid)
+		{
+			_buildGroups();
+		}
+
+		size_t groupCount = mGroupStarts.size() - 1;
+		if(mPool)
+		{
+			mPool->parallelFor(groupCount,0,&IKBatch::_solveGroups,this);
+		}
+		else
+		{
+			_solveGroups(0,groupCount,this);
+		}
+	}
+
+	void IKBatch::_solveGroups( size_t first, size_t last, void* userData )
+	{
+		IKBatch* batch = (IKBatch*)userData;
+
+		for(size_t group = first; group < last; ++group)
+		{
+			//Only one thread touches a group, so its solver needs no locking
+			IKSolver& solver = batch->mGroupSolvers[group];
+			solver.copySettings(batch->mSolver);
+			for(size_t i = batch->mGroupStarts[group]; i < batch->mGroupStarts[group + 1]; ++i)
+			{
+				size_t index = batch->mGroupedJobs[i];
+				const IKJob& job = batch->mJobs[index];
+				IKResult& result = batch->mResults[index];
+
+				//Stale handles resolve to NULL and the solver returns false
+				result.solved = solver.solve(job.skeleton,job.effector,job.targetX,job.targetY);
+				result.iterations = solver.getIterationCount();
+			}
+		}
+	}
+
+	const IKResult& IKBatch::getResult( int job ) const
+	{
+		return mResults[job];
+	}
+
+	const IKResult* IKBatch::getResults() const
+	{
+		return mResults.empty() ? NULL : &mResults[0];
+	}
+}
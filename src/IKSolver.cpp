@@ -7,7 +7,9 @@ namespace skl{
 
 	IKSolver::IKSolver(void)
 		: mSolvedRadiusSquared(1.0f),mConstraints(true),
-		mFixtures(true),mMaxIter(20)
+		mFixtures(true),mMaxIter(20),mMethod(CCD),
+		mBendDirection(BEND_KEEP),mAnalyticTwoBone(true),mIterations(0),
+		mCoherent(false),mStallDistance(0.01f)
 	{
 	}
 
@@ -55,10 +57,9 @@ namespace skl{
 				sinRotAng = (curToEndX*curToTargetY - curToEndY*curToTargetX) / endTargetMag;
 			}
 
-			//Clamp the cosine into range when computing the angle
-			float rotAng = acosf( std::max(-1.0f, std::min(1.0f,cosRotAng) ) );
-			if( sinRotAng < 0.0f )
-				rotAng = -rotAng;
+			//The angle of exactly the rotation applied to the end effector.
+			//acosf of the cosine lost small rotations to about 3.5e-4 radians.
+			float rotAng = atan2f(sinRotAng,cosRotAng);
 
 			//Rotate the end effector position.
 			endX = targetBone->getParent()->getFrameX() + cosRotAng*curToEndX - sinRotAng*curToEndY;
@@ -85,7 +86,7 @@ namespace skl{
 			}
 
 			//Stop at fixtures
-			if(targetBone->isFixture())
+			if(mFixtures && targetBone->isFixture())
 			{
 				break;
 			}
@@ -97,13 +98,7 @@ namespace skl{
 
 	float IKSolver::_simplifyAngle( float angle ) const
 	{
-		angle = fmod(angle,SK_TWO_PI);
-
-		if( angle < -SK_PI )
-			angle += SK_TWO_PI;
-		else if( angle > SK_PI )
-			angle -= SK_TWO_PI;
-		return angle;
+		return shortestArc(angle);
 	}
 
 	void IKSolver::setSolvedRadius( float radius )
@@ -146,52 +141,531 @@ namespace skl{
 		return mMaxIter;
 	}
 
+	size_t IKSolver::getIterationCount() const
+	{
+		return mIterations;
+	}
+
+	void IKSolver::setCoherent( bool coherent )
+	{
+		mCoherent = coherent;
+		if(!coherent)
+		{
+			clearCoherentStates();
+		}
+	}
+
+	bool IKSolver::isCoherent() const
+	{
+		return mCoherent;
+	}
+
+	void IKSolver::setStallDistance( float distance )
+	{
+		mStallDistance = distance;
+	}
+
+	float IKSolver::getStallDistance() const
+	{
+		return mStallDistance;
+	}
+
+	void IKSolver::clearCoherentStates()
+	{
+		mCoherentStates.clear();
+	}
+
+	void IKSolver::copySettings( const IKSolver& solver )
+	{
+		//Everything but scratch buffers and coherent states
+		mSolvedRadiusSquared = solver.mSolvedRadiusSquared;
+		mConstraints = solver.mConstraints;
+		mFixtures = solver.mFixtures;
+		mMaxIter = solver.mMaxIter;
+		mMethod = solver.mMethod;
+		mBendDirection = solver.mBendDirection;
+		mAnalyticTwoBone = solver.mAnalyticTwoBone;
+		mStallDistance = solver.mStallDistance;
+		setCoherent(solver.mCoherent);
+	}
+
+	Bone* IKSolver::_getChainTop( Bone* targetBone ) const
+	{
+		//Mirrors the walk in solveIteration: the last bone it rotates
+		while(targetBone->getParent() && targetBone->getParent()->getParent())
+		{
+			if(mFixtures && targetBone->isFixture())
+			{
+				break;
+			}
+
+			targetBone = targetBone->getParent();
+		}
+
+		return targetBone;
+	}
+
+	void IKSolver::setMethod( Method method )
+	{
+		mMethod = method;
+	}
+
+	IKSolver::Method IKSolver::getMethod() const
+	{
+		return mMethod;
+	}
+
+	void IKSolver::setBendDirection( BendDirection direction )
+	{
+		mBendDirection = direction;
+	}
+
+	IKSolver::BendDirection IKSolver::getBendDirection() const
+	{
+		return mBendDirection;
+	}
+
+	void IKSolver::setAnalyticTwoBone( bool analytic )
+	{
+		mAnalyticTwoBone = analytic;
+	}
+
+	bool IKSolver::isUsingAnalyticTwoBone() const
+	{
+		return mAnalyticTwoBone;
+	}
+
 	bool IKSolver::solve( Skeleton* skeleton,Bone* targetBone, float targetX, float targetY )
 	{
+		return solve(skeleton,targetBone,targetX,targetY,mMethod);
+	}
+
+	bool IKSolver::solve( Skeleton* skeleton,const std::string& boneName, float targetX, float targetY )
+	{
+		return solve(skeleton,boneName,targetX,targetY,mMethod);
+	}
+
+	bool IKSolver::solve( Skeleton* skeleton,Bone* targetBone, float targetX, float targetY,
+		Method method )
+	{
+		mIterations = 0;
+		if(!targetBone)
+		{
+			return false;
+		}
+
+		if(mCoherent)
+		{
+			//Nothing to do when the effector already sits on the target
+			float endToTargetX = targetX - targetBone->getFrameX();
+			float endToTargetY = targetY - targetBone->getFrameY();
+			if( endToTargetX*endToTargetX + endToTargetY*endToTargetY <= mSolvedRadiusSquared )
+			{
+				_storeCoherentState(skeleton,targetBone,targetX,targetY,true);
+				return true;
+			}
+
+			_warmStart(skeleton,targetBone,targetX,targetY);
+		}
+
 		bool solved = false;
-		for(size_t i = 0; i < mMaxIter && !solved; ++i)
+		if(mAnalyticTwoBone && _isTwoBoneChain(targetBone))
 		{
-			solved = solveIteration(targetBone,targetX,targetY);
-			skeleton->updateBones();
+			solved = solveTwoBone(skeleton,targetBone,targetX,targetY);
+		}
+		else if(method == FABRIK)
+		{
+			solved = _solveFABRIK(skeleton,targetBone,targetX,targetY);
+		}
+		else
+		{
+			solved = _solveCCD(skeleton,targetBone,targetX,targetY);
+		}
+
+		if(mCoherent)
+		{
+			_storeCoherentState(skeleton,targetBone,targetX,targetY,solved);
 		}
 
 		return solved;
 	}
 
-	bool IKSolver::solve( Skeleton* skeleton,const std::string& boneName, float targetX, float targetY )
+	bool IKSolver::solve( Skeleton* skeleton,const std::string& boneName, float targetX, float targetY,
+		Method method )
 	{
-		if(!skeleton->contains(boneName))
+		//Resolving the name costs a map lookup, keep a BoneId for per frame solves
+		Bone* bone = skeleton->getByName(boneName);
+		if(!bone)
 		{
+			mIterations = 0;
 			return false;
 		}
 
-		bool solved = false;
+		return solve(skeleton,bone,targetX,targetY,method);
+	}
+
+	bool IKSolver::solve( Skeleton* skeleton,BoneId bone, float targetX, float targetY )
+	{
+		return solve(skeleton,bone,targetX,targetY,mMethod);
+	}
+
+	bool IKSolver::solve( Skeleton* skeleton,BoneId bone, float targetX, float targetY,
+		Method method )
+	{
+		//Stale handles resolve to NULL
+		return solve(skeleton,skeleton->getBone(bone),targetX,targetY,method);
+	}
 
-		Bone* targetBone = skeleton->getByName(boneName);
+	bool IKSolver::_solveCCD( Skeleton* skeleton,Bone* targetBone, float targetX, float targetY )
+	{
+		//Only the chain and its descendants move while iterating
+		Bone* chainTop = _getChainTop(targetBone);
 
-		for(size_t i = 0; i < mMaxIter && !solved; ++i)
+		bool solved = false;
+		float lastDistance = -1.0f;
+		while(mIterations < mMaxIter && !solved)
 		{
 			solved = solveIteration(targetBone,targetX,targetY);
-			skeleton->updateBones();
+			skeleton->updateBones(chainTop);
+			mIterations++;
+
+			if(mCoherent && !solved && _isStalled(targetBone,targetX,targetY,lastDistance))
+			{
+				break;
+			}
 		}
 
+		skeleton->updateBones();
 		return solved;
 	}
 
-	float IKSolver::_constrainAngle( Bone* bone, float angle ) const
+	bool IKSolver::_isStalled( Bone* targetBone, float targetX, float targetY,
+		float& lastDistance ) const
 	{
-		if(angle > bone->getMaxAngle())
+		float endToTargetX = targetX - targetBone->getFrameX();
+		float endToTargetY = targetY - targetBone->getFrameY();
+		float distance = sqrt(endToTargetX*endToTargetX + endToTargetY*endToTargetY);
+
+		bool stalled = lastDistance >= 0.0f && lastDistance - distance < mStallDistance;
+		lastDistance = distance;
+		return stalled;
+	}
+
+	void IKSolver::_warmStart( Skeleton* skeleton,Bone* targetBone, float targetX, float targetY )
+	{
+		std::map<Bone*,CoherentState>::iterator it = mCoherentStates.find(targetBone);
+		if(it == mCoherentStates.end() || !it->second.solved)
+		{
+			return;
+		}
+
+		//Bones may have been removed since, or a new bone may sit at the old
+		//address. The generation checked handles catch both.
+		const CoherentState& state = it->second;
+		Bone* bone = targetBone;
+		for(size_t i = 0; i < state.bones.size(); ++i)
+		{
+			if(!bone || state.skeleton != skeleton || skeleton->getBone(state.bones[i]) != bone)
+			{
+				mCoherentStates.erase(it);
+				return;
+			}
+			bone = bone->getParent();
+		}
+
+		//The cached pose ends near its old target. Start from it when that is
+		//closer to the new target than where the effector is now, e.g. after
+		//an animation overwrote the chain.
+		float cachedToTargetX = targetX - state.targetX;
+		float cachedToTargetY = targetY - state.targetY;
+		float endToTargetX = targetX - targetBone->getFrameX();
+		float endToTargetY = targetY - targetBone->getFrameY();
+		if( cachedToTargetX*cachedToTargetX + cachedToTargetY*cachedToTargetY >=
+			endToTargetX*endToTargetX + endToTargetY*endToTargetY )
+		{
+			return;
+		}
+
+		bone = targetBone;
+		for(size_t i = 0; i < state.angles.size(); ++i)
+		{
+			bone->setAngle(state.angles[i]);
+			bone = bone->getParent();
+		}
+		skeleton->updateBones(_getChainTop(targetBone));
+	}
+
+	void IKSolver::_storeCoherentState( Skeleton* skeleton,Bone* targetBone, float targetX, float targetY,
+		bool solved )
+	{
+		CoherentState& state = mCoherentStates[targetBone];
+		state.targetX = targetX;
+		state.targetY = targetY;
+		state.solved = solved;
+		state.skeleton = skeleton;
+
+		//Angles from the effector up to the top of the chain
+		Bone* chainTop = _getChainTop(targetBone);
+		state.bones.clear();
+		state.angles.clear();
+		for(Bone* bone = targetBone; bone; bone = bone->getParent())
 		{
-			angle = bone->getMaxAngle();
+			state.bones.push_back(bone->getId());
+			state.angles.push_back(bone->getAngle());
+			if(bone == chainTop)
+			{
+				break;
+			}
 		}
+	}
 
-		if(angle < bone->getMinAngle())
+	int IKSolver::_gatherChain( Bone* targetBone )
+	{
+		//Gather the chain from the top down. A bone that is not relative
+		//does not follow its parent, so the chain ends there.
+		mChain.clear();
+		Bone* bone = targetBone;
+		while(true)
 		{
-			angle = bone->getMinAngle();
+			mChain.push_back(bone);
+			if(!bone->isRelative() || !bone->getParent() || !bone->getParent()->getParent()
+				|| (mFixtures && bone->isFixture()))
+			{
+				break;
+			}
+			bone = bone->getParent();
 		}
+		std::reverse(mChain.begin(),mChain.end());
 
-		return angle;
+		return (int)mChain.size();
+	}
+
+	bool IKSolver::_isTwoBoneChain( Bone* targetBone )
+	{
+		//The closed form needs the lower bone to hang straight off the upper one
+		return targetBone->getParent() && _gatherChain(targetBone) == 2 &&
+			mChain[1]->isRelative() && mChain[1]->getX() == 0.0f && mChain[1]->getY() == 0.0f &&
+			mChain[0]->getLength() > 0.00001f && mChain[1]->getLength() > 0.00001f;
 	}
 
-}
+	//Closed form solution using the law of cosines
+	bool IKSolver::solveTwoBone( Skeleton* skeleton,Bone* targetBone, float targetX, float targetY )
+	{
+		if(!_isTwoBoneChain(targetBone))
+		{
+			return false;
+		}
+
+		Bone* upper = mChain[0];
+		Bone* lower = mChain[1];
+
+		float baseX = upper->getX();
+		float baseY = upper->getY();
+		float baseAngle = 0.0f;
+		if(upper->isRelative())
+		{
+			baseX += upper->getParent()->getFrameX();
+			baseY += upper->getParent()->getFrameY();
+			baseAngle = _simplifyAngle(upper->getParent()->getFrameAngle());
+		}
+
+		float upperLength = upper->getLength();
+		float lowerLength = lower->getLength();
+		float toTargetX = targetX - baseX;
+		float toTargetY = targetY - baseY;
+		float distance = sqrt(toTargetX*toTargetX + toTargetY*toTargetY);
+
+		//Aim along the current upper bone when the target sits on the base
+		if(distance <= 0.00001f)
+		{
+			toTargetX = cos(upper->getFrameAngle());
+			toTargetY = sin(upper->getFrameAngle());
+		}
+
+		//Clamp unreachable targets to the nearest reachable distance
+		distance = std::max(fabs(upperLength - lowerLength),
+			std::min(upperLength + lowerLength,distance));
+
+		float cosLower = (distance*distance - upperLength*upperLength - lowerLength*lowerLength) /
+			(2.0f * upperLength * lowerLength);
+		float lowerAngle = acosf( std::max(-1.0f, std::min(1.0f,cosLower) ) );
+
+		bool positive = mBendDirection == BEND_POSITIVE;
+		if(mBendDirection == BEND_KEEP)
+		{
+			positive = _simplifyAngle(lower->getAngle()) >= 0.0f;
+		}
+		if(!positive)
+		{
+			lowerAngle = -lowerAngle;
+		}
+
+		float upperAngle = atan2(toTargetY,toTargetX) - atan2(lowerLength * sin(lowerAngle),
+			upperLength + lowerLength * cos(lowerAngle));
+		upperAngle = _simplifyAngle(upperAngle - baseAngle);
+
+		if(mConstraints)
+		{
+			upperAngle = upper->constrainAngle(upperAngle);
+			lowerAngle = lower->constrainAngle(lowerAngle);
+		}
+
+		upper->setAngle(upperAngle);
+		lower->setAngle(lowerAngle);
+		skeleton->updateBones(upper);
+		mIterations = 1;
+
+		float endToTargetX = targetX - targetBone->getFrameX();
+		float endToTargetY = targetY - targetBone->getFrameY();
+		bool solved = endToTargetX*endToTargetX + endToTargetY*endToTargetY <= mSolvedRadiusSquared;
+
+		skeleton->updateBones();
+		return solved;
+	}
+
+	//FABRIK based on: Aristidou and Lasenby, "FABRIK: A fast, iterative solver
+	//for the Inverse Kinematics problem". A bone places its end at
+	//(parent end + (x,y) + length * direction), so each joint is reached
+	//through the bone's fixed offset before the length constraint applies.
+	bool IKSolver::_solveFABRIK( Skeleton* skeleton,Bone* targetBone, float targetX, float targetY )
+	{
+		if(!targetBone->getParent())
+		{
+			return false;
+		}
+
+		int n = _gatherChain(targetBone);
+		Bone* chainTop = mChain[0];
+
+		float baseX = 0.0f;
+		float baseY = 0.0f;
+		float baseAngle = 0.0f;
+		if(chainTop->isRelative() && chainTop->getParent())
+		{
+			baseX = chainTop->getParent()->getFrameX();
+			baseY = chainTop->getParent()->getFrameY();
+			baseAngle = _simplifyAngle(chainTop->getParent()->getFrameAngle());
+		}
+
+		bool limited = false;
+		mJointX.resize(n + 1);
+		mJointY.resize(n + 1);
+		mJointX[0] = baseX;
+		mJointY[0] = baseY;
+		for(int i = 0; i < n; ++i)
+		{
+			mJointX[i + 1] = mChain[i]->getFrameX();
+			mJointY[i + 1] = mChain[i]->getFrameY();
+			limited = limited || (mConstraints && mChain[i]->hasAngleLimits());
+		}
+
+		float lastDistance = -1.0f;
+		for(mIterations = 0; mIterations < mMaxIter; ++mIterations)
+		{
+			float endToTargetX = targetX - mJointX[n];
+			float endToTargetY = targetY - mJointY[n];
+			float distanceSquared = endToTargetX*endToTargetX + endToTargetY*endToTargetY;
+			if( distanceSquared <= mSolvedRadiusSquared )
+			{
+				break;
+			}
+
+			//Give up once an iteration stops bringing the end closer
+			if(mCoherent)
+			{
+				float distance = sqrt(distanceSquared);
+				if(lastDistance >= 0.0f && lastDistance - distance < mStallDistance)
+				{
+					break;
+				}
+				lastDistance = distance;
+			}
+
+			//Forward reaching: pin the end effector to the target
+			mJointX[n] = targetX;
+			mJointY[n] = targetY;
+			for(int i = n - 1; i >= 0; --i)
+			{
+				float startX = mJointX[i] + mChain[i]->getX();
+				float startY = mJointY[i] + mChain[i]->getY();
+				float dirX = startX - mJointX[i + 1];
+				float dirY = startY - mJointY[i + 1];
+				float mag = sqrt(dirX*dirX + dirY*dirY);
+				if(mag > 0.00001f)
+				{
+					float scale = mChain[i]->getLength() / mag;
+					startX = mJointX[i + 1] + dirX * scale;
+					startY = mJointY[i + 1] + dirY * scale;
+				}
+				mJointX[i] = startX - mChain[i]->getX();
+				mJointY[i] = startY - mChain[i]->getY();
+			}
+
+			//Backward reaching: pin the base back in place
+			mJointX[0] = baseX;
+			mJointY[0] = baseY;
+			float parentAngle = baseAngle;
+			for(int i = 0; i < n; ++i)
+			{
+				float startX = mJointX[i] + mChain[i]->getX();
+				float startY = mJointY[i] + mChain[i]->getY();
+				float dirX = mJointX[i + 1] - startX;
+				float dirY = mJointY[i + 1] - startY;
+				float mag = sqrt(dirX*dirX + dirY*dirY);
+				if(mag <= 0.00001f)
+				{
+					dirX = 1.0f;
+					dirY = 0.0f;
+					mag = 1.0f;
+				}
+				dirX /= mag;
+				dirY /= mag;
+
+				//Angle limits are the only place FABRIK needs trigonometry
+				if(limited)
+				{
+					float angle = _simplifyAngle(atan2(dirY,dirX) - parentAngle);
+					float constrained = mChain[i]->constrainAngle(angle);
+					if(constrained != angle)
+					{
+						dirX = cos(parentAngle + constrained);
+						dirY = sin(parentAngle + constrained);
+					}
+					parentAngle = _simplifyAngle(parentAngle + constrained);
+				}
+
+				mJointX[i + 1] = startX + dirX * mChain[i]->getLength();
+				mJointY[i + 1] = startY + dirY * mChain[i]->getLength();
+			}
+		}
+
+		//Convert joint positions back into local angles
+		float parentAngle = baseAngle;
+		for(int i = 0; i < n; ++i)
+		{
+			float angle = mChain[i]->getAngle();
+			if(mChain[i]->getLength() > 0.00001f)
+			{
+				float dirX = mJointX[i + 1] - mJointX[i] - mChain[i]->getX();
+				float dirY = mJointY[i + 1] - mJointY[i] - mChain[i]->getY();
+				angle = _simplifyAngle(atan2(dirY,dirX) - parentAngle);
+				if(mConstraints)
+				{
+					angle = mChain[i]->constrainAngle(angle);
+				}
+				mChain[i]->setAngle(angle);
+			}
+			parentAngle = _simplifyAngle(parentAngle + angle);
+		}
+
+		skeleton->updateBones(chainTop);
+
+		float endToTargetX = targetX - targetBone->getFrameX();
+		float endToTargetY = targetY - targetBone->getFrameY();
+		bool solved = endToTargetX*endToTargetX + endToTargetY*endToTargetY <= mSolvedRadiusSquared;
+
+		skeleton->updateBones();
+		return solved;
+	}
 
+}
\ No newline at end of file
@@ -0,0 +1,382 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "SKALE/JacobianIKSolver.hpp"
+#include "SKALE/Skeleton.hpp"
+#include <math.h>
+#include <algorithm>
+
+namespace skl
+{
+	JacobianIKSolver::JacobianIKSolver(void)
+		: mSolvedRadiusSquared(1.0f), mConstraints(true), mFixtures(true),
+		mMaxIter(20), mDamping(10.0f), mMaxStep(0.5f), mIterations(0)
+	{
+	}
+
+	JacobianIKSolver::~JacobianIKSolver(void)
+	{
+	}
+
+	int JacobianIKSolver::_addJoint( Bone* bone )
+	{
+		for(int i = 0; i < (int)mJoints.size(); ++i)
+		{
+			if(mJoints[i] == bone)
+			{
+				return i;
+			}
+		}
+
+		mJoints.push_back(bone);
+		return (int)mJoints.size() - 1;
+	}
+
+	void JacobianIKSolver::_buildChains( const IKEffector* effectors, size_t count )
+	{
+		//Chains end at fixtures, below ROOT, or at bones that ignore their parent.
+		//Each chain lists its joints from the effector up.
+		mJoints.clear();
+		mChainTops.clear();
+		mChainJoints.clear();
+		mChainStarts.clear();
+		for(size_t i = 0; i < count; ++i)
+		{
+			mChainStarts.push_back(mChainJoints.size());
+			Bone* bone = effectors[i].bone;
+			while(bone->getParent())
+			{
+				mChainJoints.push_back(_addJoint(bone));
+				if(!bone->isRelative() || !bone->getParent()->getParent() ||
+					(mFixtures && bone->isFixture()))
+				{
+					mChainTops.push_back(bone);
+					break;
+				}
+				bone = bone->getParent();
+			}
+		}
+		mChainStarts.push_back(mChainJoints.size());
+
+		//Drop tops that already get updated as part of another top's subtree
+		for(size_t i = 0; i < mChainTops.size(); )
+		{
+			bool covered = false;
+			for(Bone* bone = mChainTops[i]->getParent(); bone && !covered; bone = bone->getParent())
+			{
+				for(size_t k = 0; k < mChainTops.size(); ++k)
+				{
+					if(k != i && mChainTops[k] == bone)
+					{
+						covered = true;
+						break;
+					}
+				}
+			}
+
+			bool duplicate = false;
+			for(size_t k = 0; k < i; ++k)
+			{
+				duplicate = duplicate || mChainTops[k] == mChainTops[i];
+			}
+
+			if(covered || duplicate)
+			{
+				mChainTops.erase(mChainTops.begin() + i);
+			}
+			else
+			{
+				++i;
+			}
+		}
+	}
+
+	bool JacobianIKSolver::_solveSystem( int size )
+	{
+		//Cholesky factorization of the symmetric positive definite mSystem,
+		//then solve in place for the right hand side in mError
+		for(int i = 0; i < size; ++i)
+		{
+			for(int j = 0; j <= i; ++j)
+			{
+				float sum = mSystem[i * size + j];
+				for(int k = 0; k < j; ++k)
+				{
+					sum -= mSystem[i * size + k] * mSystem[j * size + k];
+				}
+
+				if(i == j)
+				{
+					if(sum <= 0.0f)
+					{
+						return false;
+					}
+					mSystem[i * size + i] = sqrt(sum);
+				}
+				else
+				{
+					mSystem[i * size + j] = sum / mSystem[j * size + j];
+				}
+			}
+		}
+
+		for(int i = 0; i < size; ++i)
+		{
+			float sum = mError[i];
+			for(int k = 0; k < i; ++k)
+			{
+				sum -= mSystem[i * size + k] * mError[k];
+			}
+			mError[i] = sum / mSystem[i * size + i];
+		}
+
+		for(int i = size - 1; i >= 0; --i)
+		{
+			float sum = mError[i];
+			for(int k = i + 1; k < size; ++k)
+			{
+				sum -= mSystem[k * size + i] * mError[k];
+			}
+			mError[i] = sum / mSystem[i * size + i];
+		}
+
+		return true;
+	}
+
+	bool JacobianIKSolver::solve( Skeleton* skeleton, const std::vector<IKEffector>& effectors )
+	{
+		if(effectors.empty())
+		{
+			mIterations = 0;
+			return true;
+		}
+
+		return solve(skeleton,&effectors[0],effectors.size());
+	}
+
+	bool JacobianIKSolver::solve( Skeleton* skeleton, const IKEffector* effectors, size_t count )
+	{
+		mIterations = 0;
+		for(size_t i = 0; i < count; ++i)
+		{
+			if(!effectors[i].bone)
+			{
+				return false;
+			}
+		}
+
+		_buildChains(effectors,count);
+
+		int n = (int)mJoints.size();
+		int rows = (int)count * 2;
+		mJacobian.resize(rows * n);
+		mSystem.resize(rows * rows);
+		mError.resize(rows);
+		mDelta.resize(n);
+
+		bool solved = false;
+		while(true)
+		{
+			//Weighted error of every effector
+			solved = true;
+			for(size_t i = 0; i < count; ++i)
+			{
+				float endToTargetX = effectors[i].targetX - effectors[i].bone->getFrameX();
+				float endToTargetY = effectors[i].targetY - effectors[i].bone->getFrameY();
+				if( endToTargetX*endToTargetX + endToTargetY*endToTargetY > mSolvedRadiusSquared )
+				{
+					solved = false;
+				}
+
+				float weight = sqrt(std::max(0.0f,effectors[i].weight));
+				mError[i * 2] = weight * endToTargetX;
+				mError[i * 2 + 1] = weight * endToTargetY;
+			}
+
+			if(solved || mIterations >= mMaxIter || n == 0)
+			{
+				break;
+			}
+
+			//updateBones places a child at its parent's end plus its own (x, y)
+			//offset without rotating that offset. Turning a joint therefore
+			//rotates only the bone vectors from that joint down to the effector,
+			//so the column is the perpendicular of their sum, not of the vector
+			//from the pivot to the effector.
+			std::fill(mJacobian.begin(),mJacobian.end(),0.0f);
+			for(size_t i = 0; i < count; ++i)
+			{
+				float weight = sqrt(std::max(0.0f,effectors[i].weight));
+				float sumX = 0.0f;
+				float sumY = 0.0f;
+				for(size_t k = mChainStarts[i]; k < mChainStarts[i + 1]; ++k)
+				{
+					int j = mChainJoints[k];
+					Bone* joint = mJoints[j];
+					float startX = joint->getX();
+					float startY = joint->getY();
+					if(joint->isRelative() && joint->getParent())
+					{
+						startX += joint->getParent()->getFrameX();
+						startY += joint->getParent()->getFrameY();
+					}
+					sumX += joint->getFrameX() - startX;
+					sumY += joint->getFrameY() - startY;
+					mJacobian[(i * 2) * n + j] = -weight * sumY;
+					mJacobian[(i * 2 + 1) * n + j] = weight * sumX;
+				}
+			}
+
+			//(J * J^T + damping^2 * I) * y = error
+			for(int r = 0; r < rows; ++r)
+			{
+				for(int c = 0; c <= r; ++c)
+				{
+					float sum = 0.0f;
+					for(int j = 0; j < n; ++j)
+					{
+						sum += mJacobian[r * n + j] * mJacobian[c * n + j];
+					}
+					if(r == c)
+					{
+						sum += mDamping * mDamping;
+					}
+					mSystem[r * rows + c] = sum;
+					mSystem[c * rows + r] = sum;
+				}
+			}
+
+			if(!_solveSystem(rows))
+			{
+				break;
+			}
+
+			//Joint step = J^T * y, scaled down to the largest allowed step
+			float largest = 0.0f;
+			for(int j = 0; j < n; ++j)
+			{
+				float sum = 0.0f;
+				for(int r = 0; r < rows; ++r)
+				{
+					sum += mJacobian[r * n + j] * mError[r];
+				}
+				mDelta[j] = sum;
+				largest = std::max(largest,(float)fabs(sum));
+			}
+
+			float scale = largest > mMaxStep ? mMaxStep / largest : 1.0f;
+			for(int j = 0; j < n; ++j)
+			{
+				float angle = shortestArc(mJoints[j]->getAngle() + mDelta[j] * scale);
+				if(mConstraints)
+				{
+					angle = mJoints[j]->constrainAngle(angle);
+				}
+				mJoints[j]->setAngle(angle);
+			}
+
+			for(size_t i = 0; i < mChainTops.size(); ++i)
+			{
+				skeleton->updateBones(mChainTops[i]);
+			}
+
+			mIterations++;
+		}
+
+		skeleton->updateBones();
+		return solved;
+	}
+
+	void JacobianIKSolver::setSolvedRadius( float radius )
+	{
+		//Same convention as IKSolver::setSolvedRadius
+		mSolvedRadiusSquared = radius * 2.0f;
+	}
+
+	float JacobianIKSolver::getSolvedRadiusSquared() const
+	{
+		return mSolvedRadiusSquared;
+	}
+
+	void JacobianIKSolver::setAngleLimits( bool limited )
+	{
+		mConstraints = limited;
+	}
+
+	bool JacobianIKSolver::isAngleLimited() const
+	{
+		return mConstraints;
+	}
+
+	void JacobianIKSolver::setStopAtFixture( bool stopping )
+	{
+		mFixtures = stopping;
+	}
+
+	bool JacobianIKSolver::isStoppingAtFixture() const
+	{
+		return mFixtures;
+	}
+
+	void JacobianIKSolver::setMaxIterations( size_t iterations )
+	{
+		mMaxIter = iterations;
+	}
+
+	size_t JacobianIKSolver::getMaxIterations() const
+	{
+		return mMaxIter;
+	}
+
+	void JacobianIKSolver::setDamping( float damping )
+	{
+		mDamping = damping;
+	}
+
+	float JacobianIKSolver::getDamping() const
+	{
+		return mDamping;
+	}
+
+	void JacobianIKSolver::setMaxStep( float radians )
+	{
+		mMaxStep = radians;
+	}
+
+	float JacobianIKSolver::getMaxStep() const
+	{
+		return mMaxStep;
+	}
+
+	size_t JacobianIKSolver::getIterationCount() const
+	{
+		return mIterations;
+	}
+}
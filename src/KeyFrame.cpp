@@ -56,3 +56,108 @@ bool KeyFrame::operator<( const KeyFrame& key )
 {
 	return getFrame() < key.getFrame();
 }
+
+float shortestArc( float delta )
+{
+	delta = fmod(delta,SK_TWO_PI);
+	if(delta > SK_PI)
+		delta -= SK_TWO_PI;
+	else if(delta < -SK_PI)
+		delta += SK_TWO_PI;
+	return delta;
+}
+
+float sampleKeyFrames( const std::vector<KeyFrame>& keyFrames, float frame )
+{
+	if(keyFrames.empty())
+	{
+		return 0.0f;
+	}
+	if(frame <= (float)keyFrames.front().getFrame())
+	{
+		return keyFrames.front().getValue();
+	}
+	if(frame >= (float)keyFrames.back().getFrame())
+	{
+		return keyFrames.back().getValue();
+	}
+
+	//First key after frame, the one before it starts the segment
+	size_t low = 0;
+	size_t high = keyFrames.size() - 1;
+	while(low < high)
+	{
+		size_t mid = (low + high) / 2;
+		if((float)keyFrames[mid].getFrame() <= frame)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+
+	const KeyFrame& start = keyFrames[low - 1];
+	const KeyFrame& end = keyFrames[low];
+	float t = (frame - (float)start.getFrame()) /
+		(float)(end.getFrame() - start.getFrame());
+
+	return start.getValue() + shortestArc(end.getValue() - start.getValue()) * t;
+}
+
+KeyFrameReduction reduceKeyFrames( std::vector<KeyFrame>& keyFrames, float tolerance )
+{
+	KeyFrameReduction reduction;
+	reduction.originalCount = keyFrames.size();
+	reduction.reducedCount = keyFrames.size();
+	reduction.maxError = 0.0f;
+	if(keyFrames.size() < 3)
+	{
+		return reduction;
+	}
+
+	//Both curves are linear between the original keys, so checking the
+	//dropped keys against the span that replaces them bounds the error
+	std::vector<KeyFrame> reduced;
+	reduced.push_back(keyFrames[0]);
+	size_t anchor = 0;
+	while(anchor + 1 < keyFrames.size())
+	{
+		size_t end = anchor + 1;
+		float spanError = 0.0f;
+		for(size_t next = anchor + 2; next < keyFrames.size(); ++next)
+		{
+			const KeyFrame& from = keyFrames[anchor];
+			const KeyFrame& to = keyFrames[next];
+			float span = shortestArc(to.getValue() - from.getValue());
+			float length = (float)(to.getFrame() - from.getFrame());
+			if(length <= 0.0f)
+			{
+				break;
+			}
+			float worst = 0.0f;
+			for(size_t k = anchor + 1; k < next; ++k)
+			{
+				float t = (float)(keyFrames[k].getFrame() - from.getFrame()) / length;
+				float error = fabs(shortestArc(from.getValue() + span * t - keyFrames[k].getValue()));
+				worst = error > worst ? error : worst;
+			}
+
+			if(worst > tolerance)
+			{
+				break;
+			}
+			end = next;
+			spanError = worst;
+		}
+
+		reduced.push_back(keyFrames[end]);
+		reduction.maxError = spanError > reduction.maxError ? spanError : reduction.maxError;
+		anchor = end;
+	}
+
+	keyFrames.swap(reduced);
+	reduction.reducedCount = keyFrames.size();
+	return reduction;
+}
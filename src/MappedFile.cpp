@@ -0,0 +1,174 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "SKALE/MappedFile.hpp"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace skl
+{
+#ifdef _WIN32
+	MappedFile::MappedFile(void)
+		: mData(NULL), mSize(0), mFile(INVALID_HANDLE_VALUE), mMapping(NULL)
+	{
+	}
+
+	bool MappedFile::open( const std::string& fileName )
+	{
+		close();
+		mFile = CreateFileA(fileName.c_str(),GENERIC_READ,FILE_SHARE_READ,NULL,
+			OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,NULL);
+		if(mFile == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER size;
+		if(!GetFileSizeEx(mFile,&size) || size.QuadPart == 0)
+		{
+			close();
+			return false;
+		}
+
+		mMapping = CreateFileMappingA(mFile,NULL,PAGE_READONLY,0,0,NULL);
+		if(!mMapping)
+		{
+			close();
+			return false;
+		}
+
+		mData = MapViewOfFile(mMapping,FILE_MAP_READ,0,0,0);
+		if(!mData)
+		{
+			close();
+			return false;
+		}
+
+		mSize = (size_t)size.QuadPart;
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if(mData)
+		{
+			UnmapViewOfFile(mData);
+		}
+		if(mMapping)
+		{
+			CloseHandle(mMapping);
+		}
+		if(mFile != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(mFile);
+		}
+
+		mData = NULL;
+		mSize = 0;
+		mMapping = NULL;
+		mFile = INVALID_HANDLE_VALUE;
+	}
+#else
+	MappedFile::MappedFile(void)
+		: mData(NULL), mSize(0), mFile(-1)
+	{
+	}
+
+	bool MappedFile::open( const std::string& fileName )
+	{
+		close();
+		mFile = ::open(fileName.c_str(),O_RDONLY);
+		if(mFile < 0)
+		{
+			return false;
+		}
+
+		struct stat info;
+		if(fstat(mFile,&info) != 0 || info.st_size == 0)
+		{
+			close();
+			return false;
+		}
+
+		void* data = mmap(NULL,(size_t)info.st_size,PROT_READ,MAP_PRIVATE,mFile,0);
+		if(data == MAP_FAILED)
+		{
+			close();
+			return false;
+		}
+
+		mData = data;
+		mSize = (size_t)info.st_size;
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if(mData)
+		{
+			munmap(const_cast<void*>(mData),mSize);
+		}
+		if(mFile >= 0)
+		{
+			::close(mFile);
+		}
+
+		mData = NULL;
+		mSize = 0;
+		mFile = -1;
+	}
+#endif
+
+	MappedFile::~MappedFile(void)
+	{
+		close();
+	}
+
+	bool MappedFile::isOpen() const
+	{
+		return mData != NULL;
+	}
+
+	const void* MappedFile::getData() const
+	{
+		return mData;
+	}
+
+	size_t MappedFile::getSize() const
+	{
+		return mSize;
+	}
+}
@@ -0,0 +1,79 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "SKALE/PoseArena.hpp"
+
+namespace skl
+{
+	PoseArena::PoseArena(void)
+		: mUsed(0)
+	{
+	}
+
+	PoseArena::~PoseArena(void)
+	{
+	}
+
+	void PoseArena::reserve( size_t count )
+	{
+		if(count > mBuffer.size())
+		{
+			mBuffer.resize(count);
+		}
+	}
+
+	float* PoseArena::allocate( size_t count )
+	{
+		//NULL when the arena is full, it never grows behind the caller's back
+		if(count == 0 || mUsed + count > mBuffer.size())
+		{
+			return NULL;
+		}
+
+		float* block = &mBuffer[mUsed];
+		mUsed += count;
+		return block;
+	}
+
+	void PoseArena::reset()
+	{
+		mUsed = 0;
+	}
+
+	size_t PoseArena::getCapacity() const
+	{
+		return mBuffer.size();
+	}
+
+	size_t PoseArena::getUsed() const
+	{
+		return mUsed;
+	}
+}
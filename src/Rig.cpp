@@ -0,0 +1,155 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "SKALE/Rig.hpp"
+#include "SKALE/Skeleton.hpp"
+
+namespace skl
+{
+	Rig::Rig( Skeleton& skeleton )
+	{
+		const FlatSkeleton& flat = skeleton.getFlatBones();
+		int n = flat.count();
+
+		mNames.reserve(n);
+		mParents.reserve(n);
+		mSubtreeEnds.reserve(n);
+		mRelative.reserve(n);
+		mFixture.reserve(n);
+		mMinAngle.reserve(n);
+		mMaxAngle.reserve(n);
+		mRestX.reserve(n);
+		mRestY.reserve(n);
+		mRestAngle.reserve(n);
+		mRestLength.reserve(n);
+
+		for(int i = 0; i < n; ++i)
+		{
+			const Bone* bone = flat.getBone(i);
+			mNames.push_back(bone->getName());
+			mIndices[bone->getName()] = i;
+			mParents.push_back(flat.getParentIndex(i));
+			mSubtreeEnds.push_back(flat.getSubtreeEnd(i));
+			mRelative.push_back(bone->isRelative());
+			mFixture.push_back(bone->isFixture());
+			mMinAngle.push_back(bone->getMinAngle());
+			mMaxAngle.push_back(bone->getMaxAngle());
+			mRestX.push_back(bone->getX());
+			mRestY.push_back(bone->getY());
+			mRestAngle.push_back(bone->getAngle());
+			mRestLength.push_back(bone->getLength());
+		}
+	}
+
+	Rig::~Rig(void)
+	{
+	}
+
+	int Rig::count() const
+	{
+		return (int)mNames.size();
+	}
+
+	int Rig::findBone( const std::string& name ) const
+	{
+		std::map<std::string,int>::const_iterator it = mIndices.find(name);
+		if(it == mIndices.end())
+		{
+			return -1;
+		}
+
+		return it->second;
+	}
+
+	const std::string& Rig::getName( int index ) const
+	{
+		return mNames[index];
+	}
+
+	int Rig::getParentIndex( int index ) const
+	{
+		return mParents[index];
+	}
+
+	int Rig::getSubtreeEnd( int index ) const
+	{
+		return mSubtreeEnds[index];
+	}
+
+	bool Rig::isRelative( int index ) const
+	{
+		return mRelative[index] != 0;
+	}
+
+	bool Rig::isFixture( int index ) const
+	{
+		return mFixture[index] != 0;
+	}
+
+	const float& Rig::getMinAngle( int index ) const
+	{
+		return mMinAngle[index];
+	}
+
+	const float& Rig::getMaxAngle( int index ) const
+	{
+		return mMaxAngle[index];
+	}
+
+	const int* Rig::getParents() const
+	{
+		return mParents.empty() ? NULL : &mParents[0];
+	}
+
+	const unsigned char* Rig::getRelativeFlags() const
+	{
+		return mRelative.empty() ? NULL : &mRelative[0];
+	}
+
+	const float* Rig::getRestX() const
+	{
+		return mRestX.empty() ? NULL : &mRestX[0];
+	}
+
+	const float* Rig::getRestY() const
+	{
+		return mRestY.empty() ? NULL : &mRestY[0];
+	}
+
+	const float* Rig::getRestAngle() const
+	{
+		return mRestAngle.empty() ? NULL : &mRestAngle[0];
+	}
+
+	const float* Rig::getRestLength() const
+	{
+		return mRestLength.empty() ? NULL : &mRestLength[0];
+	}
+}
@@ -0,0 +1,301 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "SKALE/SimdIKSolver.hpp"
+#include "SKALE/Skeleton.hpp"
+#include <math.h>
+
+namespace skl
+{
+	SimdIKSolver::SimdIKSolver(void)
+		: mFixtures(true), mMaxIter(20)
+	{
+		mScalarSolver.setAnalyticTwoBone(false);
+		mScalarSolver.setMethod(IKSolver::CCD);
+		mSolvedRadiusSquared = mScalarSolver.getSolvedRadiusSquared();
+		mScalarSolver.setStopAtFixture(mFixtures);
+		mScalarSolver.setMaxIterations(mMaxIter);
+	}
+
+	SimdIKSolver::~SimdIKSolver(void)
+	{
+	}
+
+	void SimdIKSolver::setSolvedRadius( float radius )
+	{
+		mScalarSolver.setSolvedRadius(radius);
+		mSolvedRadiusSquared = mScalarSolver.getSolvedRadiusSquared();
+	}
+
+	float SimdIKSolver::getSolvedRadiusSquared() const
+	{
+		return mSolvedRadiusSquared;
+	}
+
+	void SimdIKSolver::setStopAtFixture( bool stopping )
+	{
+		mFixtures = stopping;
+		mScalarSolver.setStopAtFixture(stopping);
+	}
+
+	bool SimdIKSolver::isStoppingAtFixture() const
+	{
+		return mFixtures;
+	}
+
+	void SimdIKSolver::setMaxIterations( size_t iterations )
+	{
+		mMaxIter = iterations;
+		mScalarSolver.setMaxIterations(iterations);
+	}
+
+	size_t SimdIKSolver::getMaxIterations() const
+	{
+		return mMaxIter;
+	}
+
+	int SimdIKSolver::_getChainLength( Bone* targetBone ) const
+	{
+		//Same walk as IKSolver::solveIteration, -1 when it needs the scalar path
+		int length = 0;
+		while(targetBone->getParent())
+		{
+			if(!targetBone->isRelative())
+			{
+				return -1;
+			}
+
+			length++;
+			if(mFixtures && targetBone->isFixture())
+			{
+				break;
+			}
+
+			targetBone = targetBone->getParent();
+		}
+
+		return length > 0 ? length : -1;
+	}
+
+	int SimdIKSolver::solve( Skeleton** skeletons, Bone** targetBones,
+		const float* targetX, const float* targetY, size_t count, bool* solved )
+	{
+		int solvedCount = 0;
+		size_t first = 0;
+
+		while(first < count)
+		{
+			int chainLength = _getChainLength(targetBones[first]);
+			if(chainLength < 0)
+			{
+				solved[first] = mScalarSolver.solve(skeletons[first],targetBones[first],
+					targetX[first],targetY[first]);
+				solvedCount += solved[first] ? 1 : 0;
+				first++;
+				continue;
+			}
+
+			//Fill the lanes with following chains of the same length
+			int lanes = 1;
+			while(lanes < SK_SIMD_WIDTH && first + lanes < count &&
+				_getChainLength(targetBones[first + lanes]) == chainLength)
+			{
+				lanes++;
+			}
+
+			solvedCount += _solveLanes(skeletons + first,targetBones + first,
+				targetX + first,targetY + first,lanes,chainLength,solved + first);
+			first += lanes;
+		}
+
+		return solvedCount;
+	}
+
+	int SimdIKSolver::_solveLanes( Skeleton** skeletons, Bone** targetBones,
+		const float* targetX, const float* targetY,
+		int lanes, int chainLength, bool* solved )
+	{
+		const int W = SK_SIMD_WIDTH;
+		int size = chainLength * W;
+		mBones.resize(size);
+		mLocalCos.resize(size);
+		mLocalSin.resize(size);
+		mOffsetX.resize(size);
+		mOffsetY.resize(size);
+		mLength.resize(size);
+		mJointX.resize(size);
+		mJointY.resize(size);
+
+		float baseX[SK_SIMD_WIDTH];
+		float baseY[SK_SIMD_WIDTH];
+		float baseCos[SK_SIMD_WIDTH];
+		float baseSin[SK_SIMD_WIDTH];
+		float goalX[SK_SIMD_WIDTH];
+		float goalY[SK_SIMD_WIDTH];
+		float done[SK_SIMD_WIDTH];
+
+		//Gather chains into SoA rows, row 0 is the top of each chain.
+		//Unused lanes repeat lane 0 and start out converged.
+		for(int l = 0; l < W; ++l)
+		{
+			int source = l < lanes ? l : 0;
+			Bone* bone = targetBones[source];
+			for(int j = chainLength - 1; j >= 0; --j)
+			{
+				int index = j * W + l;
+				mBones[index] = bone;
+				mLocalCos[index] = cos(bone->getAngle());
+				mLocalSin[index] = sin(bone->getAngle());
+				mOffsetX[index] = bone->getX();
+				mOffsetY[index] = bone->getY();
+				mLength[index] = bone->getLength();
+				bone = bone->getParent();
+			}
+
+			baseX[l] = bone->getFrameX();
+			baseY[l] = bone->getFrameY();
+			baseCos[l] = cos(bone->getFrameAngle());
+			baseSin[l] = sin(bone->getFrameAngle());
+			goalX[l] = targetX[source];
+			goalY[l] = targetY[source];
+			done[l] = l < lanes ? 0.0f : 1.0f;
+		}
+
+		SkVec doneMask = skLessEqual(skSet(0.5f),skLoad(done));
+
+		const SkVec one = skSet(1.0f);
+		const SkVec zero = skSet(0.0f);
+		const SkVec epsilon = skSet(0.00001f);
+		const SkVec radius = skSet(mSolvedRadiusSquared);
+		const SkVec targetsX = skLoad(goalX);
+		const SkVec targetsY = skLoad(goalY);
+
+		for(size_t iter = 0; iter < mMaxIter; ++iter)
+		{
+			if(skMoveMask(doneMask) == (1 << W) - 1)
+			{
+				break;
+			}
+
+			//Forward kinematics along the chain: world = parent * local
+			SkVec parentCos = skLoad(baseCos);
+			SkVec parentSin = skLoad(baseSin);
+			SkVec x = skLoad(baseX);
+			SkVec y = skLoad(baseY);
+			for(int j = 0; j < chainLength; ++j)
+			{
+				int row = j * W;
+				SkVec localCos = skLoad(&mLocalCos[row]);
+				SkVec localSin = skLoad(&mLocalSin[row]);
+				SkVec worldCos = skSub(skMul(parentCos,localCos),skMul(parentSin,localSin));
+				SkVec worldSin = skAdd(skMul(parentCos,localSin),skMul(parentSin,localCos));
+				SkVec length = skLoad(&mLength[row]);
+				x = skAdd(skAdd(x,skLoad(&mOffsetX[row])),skMul(length,worldCos));
+				y = skAdd(skAdd(y,skLoad(&mOffsetY[row])),skMul(length,worldSin));
+				skStore(&mJointX[row],x);
+				skStore(&mJointY[row],y);
+				parentCos = worldCos;
+				parentSin = worldSin;
+			}
+
+			//One CCD sweep from the end effector to the top of the chain
+			SkVec endX = x;
+			SkVec endY = y;
+			SkVec active = skAndNot(doneMask,skTrue());
+			for(int j = chainLength - 1; j >= 0; --j)
+			{
+				int row = j * W;
+				SkVec pivotX = j > 0 ? skLoad(&mJointX[row - W]) : skLoad(baseX);
+				SkVec pivotY = j > 0 ? skLoad(&mJointY[row - W]) : skLoad(baseY);
+
+				SkVec curToEndX = skSub(endX,pivotX);
+				SkVec curToEndY = skSub(endY,pivotY);
+				SkVec curToTargetX = skSub(targetsX,pivotX);
+				SkVec curToTargetY = skSub(targetsY,pivotY);
+				SkVec endTargetMag = skMul(
+					skSqrt(skAdd(skMul(curToEndX,curToEndX),skMul(curToEndY,curToEndY))),
+					skSqrt(skAdd(skMul(curToTargetX,curToTargetX),skMul(curToTargetY,curToTargetY))));
+
+				//Converged lanes and degenerate vectors rotate by nothing
+				SkVec rotate = skAndNot(skLessEqual(endTargetMag,epsilon),active);
+				SkVec cosRot = skDiv(skAdd(skMul(curToEndX,curToTargetX),skMul(curToEndY,curToTargetY)),endTargetMag);
+				SkVec sinRot = skDiv(skSub(skMul(curToEndX,curToTargetY),skMul(curToEndY,curToTargetX)),endTargetMag);
+				cosRot = skSelect(rotate,cosRot,one);
+				sinRot = skSelect(rotate,sinRot,zero);
+
+				endX = skAdd(pivotX,skSub(skMul(cosRot,curToEndX),skMul(sinRot,curToEndY)));
+				endY = skAdd(pivotY,skAdd(skMul(sinRot,curToEndX),skMul(cosRot,curToEndY)));
+
+				//Rotate the local frame and keep it unit length
+				SkVec localCos = skLoad(&mLocalCos[row]);
+				SkVec localSin = skLoad(&mLocalSin[row]);
+				SkVec newCos = skSub(skMul(localCos,cosRot),skMul(localSin,sinRot));
+				SkVec newSin = skAdd(skMul(localCos,sinRot),skMul(localSin,cosRot));
+				SkVec mag = skSqrt(skAdd(skMul(newCos,newCos),skMul(newSin,newSin)));
+				skStore(&mLocalCos[row],skDiv(newCos,mag));
+				skStore(&mLocalSin[row],skDiv(newSin,mag));
+
+				SkVec endToTargetX = skSub(targetsX,endX);
+				SkVec endToTargetY = skSub(targetsY,endY);
+				SkVec reached = skAnd(active,skLessEqual(
+					skAdd(skMul(endToTargetX,endToTargetX),skMul(endToTargetY,endToTargetY)),radius));
+				doneMask = skOr(doneMask,reached);
+				active = skAndNot(reached,active);
+
+				if(skMoveMask(active) == 0)
+				{
+					break;
+				}
+			}
+		}
+
+		//Scatter the solved local angles back into the bones
+		int solvedCount = 0;
+		int doneBits = skMoveMask(doneMask);
+		for(int l = 0; l < lanes; ++l)
+		{
+			for(int j = 0; j < chainLength; ++j)
+			{
+				int index = j * W + l;
+				mBones[index]->setAngle(atan2(mLocalSin[index],mLocalCos[index]));
+			}
+
+			solved[l] = (doneBits & (1 << l)) != 0;
+			solvedCount += solved[l] ? 1 : 0;
+		}
+
+		for(int l = 0; l < lanes; ++l)
+		{
+			skeletons[l]->updateBones();
+		}
+
+		return solvedCount;
+	}
+}
@@ -29,16 +29,28 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include "Skeleton.hpp"
+#include "SKALE/MappedFile.hpp"
+#include "SKALE/SkeletonJournal.hpp"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
 #include <sstream>
 #include "math.h"
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 namespace skl
 {
 	Skeleton::Skeleton(void)
-		: root(0.0f,0.0f,0.0f,0.0f,0.0f,6.283f,false,"ROOT"), boneAddedCount(0)
+		: root(0.0f,0.0f,0.0f,0.0f,0.0f,6.283f,false,"ROOT"), boneAddedCount(0),
+		flatBonesValid(false), saveCount(0)
 	{
+		_resetIds();
 	}
 
 	Skeleton::~Skeleton(void)
@@ -75,41 +87,123 @@ namespace skl
 			actualName += "_1";
 		}
 
-		bones[actualName] = parent->add(x,y,angle,length,minAngle,maxAngle,actualName);
-		return bones[actualName];
+		flatBonesValid = false;
+		Bone* bone = parent->add(x,y,angle,length,minAngle,maxAngle,actualName);
+		bone->setId(_acquireId(bone,bones.insert(std::make_pair(actualName,bone)).first));
+		return bone;
 	}
 
-	bool Skeleton::remove( Bone* bone )
+	void Skeleton::_resetIds()
 	{
-		for(std::map<std::string,Bone*>::iterator it = bones.begin();
-			it != bones.end(); ++it)
+		//The root keeps slot 0. Other slots go back on the free list with a
+		//new generation so handles from before a reload stop resolving.
+		if(boneSlots.empty())
+		{
+			BoneSlot slot;
+			slot.generation = 0;
+			boneSlots.push_back(slot);
+		}
+
+		freeSlots.clear();
+		for(int i = (int)boneSlots.size() - 1; i > 0; --i)
 		{
-			if(it->second == bone)
+			if(boneSlots[i].bone)
 			{
-				if(bone->getParent() == NULL)
-				{
-					return false; //Cannot remove root
-				}
-				else
-				{
-					bone->getParent()->remove(bone);
-					bones.erase(it);
-					return true;
-				}
+				boneSlots[i].bone = NULL;
+				boneSlots[i].generation = (boneSlots[i].generation + 1) & SK_BONE_GENERATION_MASK;
 			}
+			freeSlots.push_back(i);
+		}
+
+		boneSlots[0].bone = &root;
+		boneSlots[0].entry = bones.end();
+		root.setId(BoneId(0,boneSlots[0].generation));
+	}
+
+	BoneId Skeleton::_acquireId( Bone* bone, std::map<std::string,Bone*>::iterator entry )
+	{
+		int index;
+		if(freeSlots.empty())
+		{
+			index = (int)boneSlots.size();
+			BoneSlot slot;
+			slot.generation = 0;
+			boneSlots.push_back(slot);
+		}
+		else
+		{
+			index = freeSlots.back();
+			freeSlots.pop_back();
+		}
+
+		boneSlots[index].bone = bone;
+		boneSlots[index].entry = entry;
+		return BoneId(index,boneSlots[index].generation);
+	}
+
+	void Skeleton::_releaseIds( Bone* root )
+	{
+		//Drops the map entries of the whole subtree so none are left dangling
+		BoneSlot& slot = boneSlots[root->getId().getIndex()];
+		bones.erase(slot.entry);
+		slot.bone = NULL;
+		slot.generation = (slot.generation + 1) & SK_BONE_GENERATION_MASK;
+		freeSlots.push_back(root->getId().getIndex());
+		root->setId(BoneId());
+
+		for(std::list<Bone>::iterator it = root->begin(); it != root->end(); ++it)
+		{
+			_releaseIds(&(*it));
 		}
+	}
 
-		return false;
+	bool Skeleton::remove( Bone* bone )
+	{
+		if(!bone || bone->getParent() == NULL)
+		{
+			return false; //Cannot remove root
+		}
+
+		if(getBone(bone->getId()) != bone)
+		{
+			return false;
+		}
+
+		Bone* parent = bone->getParent();
+		_releaseIds(bone);
+		parent->remove(bone);
+		flatBonesValid = false;
+		return true;
+	}
+
+	bool Skeleton::remove( BoneId id )
+	{
+		return remove(getBone(id));
 	}
 
 	Bone* Skeleton::getByName( const std::string& name )
 	{
-		if(contains(name))
+		std::map<std::string,Bone*>::iterator it = bones.find(name);
+		return it != bones.end() ? it->second : NULL;
+	}
+
+	BoneId Skeleton::resolve( const std::string& name ) const
+	{
+		//Look names up once, then use the id every frame
+		std::map<std::string,Bone*>::const_iterator it = bones.find(name);
+		return it != bones.end() ? it->second->getId() : BoneId();
+	}
+
+	Bone* Skeleton::getBone( BoneId id ) const
+	{
+		int index = id.getIndex();
+		if(!id.isValid() || index >= (int)boneSlots.size() ||
+			boneSlots[index].generation != id.getGeneration())
 		{
-			return bones[name];
+			return NULL;
 		}
 
-		return NULL;
+		return boneSlots[index].bone;
 	}
 
 	int Skeleton::count() const
@@ -127,7 +221,68 @@ namespace skl
 		_updateBones(&root,0.0f,0.0f,0.0f);
 	}
 
-	void Skeleton::_updateBones( Bone* root,float realStartX, float realStartY, float realStartAngle )
+	const FlatSkeleton& Skeleton::getFlatBones()
+	{
+		if(!flatBonesValid)
+		{
+			flatBones.build(&root);
+			flatBonesValid = true;
+		}
+
+		return flatBones;
+	}
+
+	int Skeleton::updateBones( Bone* bone )
+	{
+		float realStartX = 0.0f;
+		float realStartY = 0.0f;
+		float realStartAngle = 0.0f;
+
+		//Start from the parent frame exactly as a full update would
+		if(bone->getParent())
+		{
+			realStartX = bone->getParent()->getFrameX();
+			realStartY = bone->getParent()->getFrameY();
+			realStartAngle = fmod(bone->getParent()->getFrameAngle(),SK_TWO_PI);
+
+			if( realStartAngle < -SK_PI)
+				realStartAngle += (SK_TWO_PI);
+			else if( realStartAngle > SK_PI)
+				realStartAngle -= (SK_TWO_PI);
+		}
+
+		return _updateBones(bone,realStartX,realStartY,realStartAngle);
+	}
+
+	int Skeleton::updateDirtyBones()
+	{
+		return _updateDirtyBones(&root);
+	}
+
+	int Skeleton::_updateDirtyBones( Bone* root )
+	{
+		if(root->isDirty())
+		{
+			return updateBones(root);
+		}
+
+		if(!root->hasDirtyChildren())
+		{
+			return 0;
+		}
+
+		root->clearDirty();
+
+		int updated = 0;
+		for(std::list<Bone>::iterator it = root->begin(); it != root->end(); ++it)
+		{
+			updated += _updateDirtyBones(&(*it));
+		}
+
+		return updated;
+	}
+
+	int Skeleton::_updateBones( Bone* root,float realStartX, float realStartY, float realStartAngle )
 	{
 		if(!root->isRelative())
 		{
@@ -145,6 +300,7 @@ namespace skl
 		realStartY += (vecY * root->getLength());
 
 		root->setFrame(realStartX,realStartY,realStartAngle);
+		root->clearDirty();
 		
 		float angle = fmod(realStartAngle,SK_TWO_PI);
 
@@ -152,133 +308,204 @@ namespace skl
 			angle += (SK_TWO_PI);
 		else if( angle > SK_PI)
 			angle -= (SK_TWO_PI);
+
+		int updated = 1;
 		for(std::list<Bone>::iterator it = root->begin(); it != root->end(); ++it)
 		{
-			_updateBones(&(*it),realStartX,realStartY,angle);
+			updated += _updateBones(&(*it),realStartX,realStartY,angle);
 		}
+
+		return updated;
 	}
 
-	bool Skeleton::save( const std::string& fileName ) const
+	static void _appendInt( std::string& out, long long value )
 	{
-		std::ofstream file = std::ofstream(fileName.c_str());
+		char digits[24];
+		int count = 0;
+		bool negative = value < 0;
+		unsigned long long magnitude = negative ? -(unsigned long long)value : value;
+		do
+		{
+			digits[count++] = (char)('0' + magnitude % 10);
+			magnitude /= 10;
+		} while(magnitude > 0);
 
-		if(!file.is_open())
+		if(negative)
 		{
-			return false;
+			out += '-';
 		}
-		
-		std::stringstream ss;
-	
-		//Add the root
-		//clear stream
-		ss.clear();
-		ss.str("");
-
-		//Level
-		ss << 0;
-		ss << " ";
-
-		//X Coordinate
-		ss << root.getX();
-		ss << " ";
-
-		//Y Coordinate
-		ss << root.getY();
-		ss << " ";
-
-		//Angle
-		ss << fmod(root.getAngle(),6.283f);
-		ss << " ";
-
-		//Length
-		ss << root.getLength();
-		ss << " ";
+		while(count > 0)
+		{
+			out += digits[--count];
+		}
+	}
 
-		//Minimum Angle
-		ss << fmod(root.getMinAngle(),6.283f);
-		ss << " ";
+	static long long _roundHalfEven( double value )
+	{
+		//Ties go to even like printf, exact for the halves a float can hold
+		double whole = floor(value);
+		double rest = value - whole;
+		long long result = (long long)whole;
+		if(rest > 0.5 || (rest == 0.5 && (result & 1)))
+		{
+			result++;
+		}
+		return result;
+	}
 
-		//Maximum Angle
-		ss << root.getMaxAngle(),6.283f;
-		ss << " ";
+	static void _appendFloat( std::string& out, float value )
+	{
+		//Six significant digits without trailing zeros, like ostream's default.
+		//Values that would need an exponent go through snprintf. Like %g the
+		//exponent is taken after rounding, so 999999.5 becomes 1e+06.
+		double magnitude = fabs((double)value);
+		if(value != value || magnitude >= 999999.5 || (magnitude < 1e-4 && magnitude != 0.0))
+		{
+			char buffer[32];
+			snprintf(buffer,sizeof(buffer),"%g",value);
+			out += buffer;
+			return;
+		}
 
-		//isRelative
-		ss << root.isRelative();
-		ss << " ";
+		if(magnitude == 0.0)
+		{
+			out += (value < 0.0f || 1.0f / value < 0.0f) ? "-0" : "0";
+			return;
+		}
 
-		//Name
-		ss << "\"" << root.getName().c_str() << "\"";
-		ss << " ";
+		static const double powers[] = {1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10};
+		int exponent = (int)floor(log10(magnitude));
+		int decimals = 5 - exponent;
+		long long scaled = _roundHalfEven(magnitude * powers[decimals]);
 
-		//Parent Name
-		ss << "\"\"";
+		//Rounding carried into a new digit, for example 9.999996
+		if(scaled >= 1000000 && decimals > 0)
+		{
+			decimals--;
+			scaled = _roundHalfEven(magnitude * powers[decimals]);
+		}
 
-		ss << std::endl;
-		file << ss.str().c_str();
+		long long whole = scaled / (long long)powers[decimals];
+		long long fraction = scaled % (long long)powers[decimals];
+		while(decimals > 0 && fraction % 10 == 0)
+		{
+			fraction /= 10;
+			decimals--;
+		}
 
-		for (std::map<std::string,Bone*>::const_iterator it = bones.begin();
-			it != bones.end(); ++it)
+		if(value < 0.0f)
 		{
-			if(!(it->second)->getParent())
+			out += '-';
+		}
+		_appendInt(out,whole);
+		if(decimals > 0)
+		{
+			out += '.';
+			char digits[16];
+			for(int i = decimals - 1; i >= 0; --i)
 			{
-				continue;
+				digits[i] = (char)('0' + fraction % 10);
+				fraction /= 10;
 			}
-			//clear stream
-			ss.clear();
-			ss.str("");
-
-			//Level
-			ss << findLevel((it->second));
-			ss << " ";
-
-			//X Coordinate
-			ss << (it->second)->getX();
-			ss << " ";
-
-			//Y Coordinate
-			ss << (it->second)->getY();
-			ss << " ";
-
-			//Angle
-			ss << fmod((it->second)->getAngle(),6.283f);
-			ss << " ";
-
-			//Length
-			ss << (it->second)->getLength();
-			ss << " ";
-
-			//Minimum Angle
-			ss << fmod((it->second)->getMinAngle(),6.283f);
-			ss << " ";
-
-			//Maximum Angle
-			ss << fmod((it->second)->getMaxAngle(),6.283f);
-			ss << " ";
-
-			//isRelative
-			ss << (it->second)->isRelative();
-			ss << " ";
-
-			//isFixture
-			ss << (it->second)->isFixture();
-			ss << " ";
-
+			out.append(digits,decimals);
+		}
+	}
 
-			//Name
-			ss << "\"" <<(it->second)->getName().c_str() << "\"";
-			ss << " ";
+	void Skeleton::_saveBones( const Bone* root, int level, std::string& out ) const
+	{
+		for(std::list<Bone>::const_iterator it = root->begin(); it != root->end(); ++it)
+		{
+			const Bone& bone = *it;
+			_appendInt(out,level);
+			out += ' ';
+			_appendFloat(out,bone.getX());
+			out += ' ';
+			_appendFloat(out,bone.getY());
+			out += ' ';
+			_appendFloat(out,fmod(bone.getAngle(),6.283f));
+			out += ' ';
+			_appendFloat(out,bone.getLength());
+			out += ' ';
+			_appendFloat(out,fmod(bone.getMinAngle(),6.283f));
+			out += ' ';
+			_appendFloat(out,fmod(bone.getMaxAngle(),6.283f));
+			out += ' ';
+			out += bone.isRelative() ? '1' : '0';
+			out += ' ';
+			out += bone.isFixture() ? '1' : '0';
+			out += " \"";
+			out += bone.getName();
+			out += "\" \"";
+			out += root->getName();
+			out += "\"\n";
+
+			_saveBones(&bone,level + 1,out);
+		}
+	}
 
-			//Parent Name
-			ss << "\"" <<(it->second)->getParent()->getName().c_str() << "\"";
+	static bool _replaceFile( const std::string& from, const std::string& to )
+	{
+#ifdef _WIN32
+		return MoveFileExA(from.c_str(),to.c_str(),MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+		return ::rename(from.c_str(),to.c_str()) == 0;
+#endif
+	}
 
-			ss << std::endl;
-			file << ss.str().c_str();
+	bool Skeleton::save( const std::string& fileName ) const
+	{
+		//Format everything into one reused buffer, then write it in one go
+		saveBuffer.clear();
+
+		//The root line has no fixture flag and its maximum angle is not wrapped
+		saveBuffer += "0 ";
+		_appendFloat(saveBuffer,root.getX());
+		saveBuffer += ' ';
+		_appendFloat(saveBuffer,root.getY());
+		saveBuffer += ' ';
+		_appendFloat(saveBuffer,fmod(root.getAngle(),6.283f));
+		saveBuffer += ' ';
+		_appendFloat(saveBuffer,root.getLength());
+		saveBuffer += ' ';
+		_appendFloat(saveBuffer,fmod(root.getMinAngle(),6.283f));
+		saveBuffer += ' ';
+		_appendFloat(saveBuffer,root.getMaxAngle());
+		saveBuffer += ' ';
+		saveBuffer += root.isRelative() ? '1' : '0';
+		saveBuffer += " \"";
+		saveBuffer += root.getName();
+		saveBuffer += "\" \"\"\n";
+
+		_saveBones(&root,1,saveBuffer);
+
+		//Write a temporary file and swap it in, a crash never leaves half a file
+		std::string tempName = fileName + ".tmp";
+		std::ofstream file(tempName.c_str(),std::ios::out | std::ios::binary);
+		if(!file.is_open())
+		{
+			return false;
 		}
 
+		file.write(saveBuffer.data(),saveBuffer.size());
 		file.close();
+		if(file.fail() || !_replaceFile(tempName,fileName))
+		{
+			::remove(tempName.c_str());
+			return false;
+		}
+
+		//The journal holds edits to the previous save. If removing it fails,
+		//its stamp no longer matches and load() ignores it.
+		::remove(SkeletonJournal::getJournalName(fileName).c_str());
+		saveCount++;
 		return true;
 	}
 
+	unsigned int Skeleton::getSaveCount() const
+	{
+		return saveCount;
+	}
+
 	int Skeleton::findLevel( const Bone* bone ) const
 	{
 		int level = 0;
@@ -292,153 +519,467 @@ namespace skl
 		return level;
 	}
 
-	bool Skeleton::load( const std::string& fileName )
+	static bool _readFile( const std::string& fileName, std::string& text )
 	{
-		std::vector<std::string> lines;
-		std::vector<std::pair<int,std::string*> > sortedList;
-
-		if(!_getLinesFromFile(fileName,lines))
+		std::ifstream file(fileName.c_str(),std::ios::in | std::ios::binary);
+		if(!file.is_open())
 		{
 			return false;
 		}
 
-		if(!_sortLinesByLevel(lines,sortedList))
+		file.seekg(0,std::ios::end);
+		std::streamoff size = file.tellg();
+		file.seekg(0,std::ios::beg);
+		text.clear();
+		if(size > 0)
+		{
+			text.resize((size_t)size);
+			file.read(&text[0],size);
+		}
+		file.close();
+		return true;
+	}
+
+	bool Skeleton::load( const std::string& fileName )
+	{
+		//Read the whole file at once and parse it in place
+		std::string text;
+		if(!_readFile(fileName,text))
 		{
+			loadError = "cannot open " + fileName;
 			return false;
 		}
 
-		_makeBonesFromSortedList(sortedList);
+		if(!parse(text.data(),text.size()))
+		{
+			return false;
+		}
 
+		//Edits made after the file was written, only if the journal was
+		//stamped for exactly this file
+		std::string header = SkeletonJournal::getHeader(text.data(),text.size());
+		if(_readFile(SkeletonJournal::getJournalName(fileName),text) &&
+			text.compare(0,header.size(),header) == 0)
+		{
+			_replayJournal(text.data() + header.size(),text.size() - header.size());
+		}
 		return true;
 	}
 
-	bool Skeleton::_getLinesFromFile( const std::string& fileName,
-		std::vector<std::string>& lines )
+	bool Skeleton::load( const SkeletonAsset& asset )
 	{
-		std::ifstream file = std::ifstream(fileName.c_str());
-
-		if(!file.is_open())
+		if(!asset.isOpen())
 		{
 			return false;
 		}
 
-		const int BUFFER_SIZE = 2048;
-		char buffer[BUFFER_SIZE];
+		root.clear();
+		bones.clear();
+		flatBonesValid = false;
+		_resetIds();
 
-		//read each line into a buffer, then into a string
-		while(!file.eof())
+		//Parents come first, so each bone can be attached as it is read
+		std::vector<Bone*> created(asset.count());
+		for(int i = 0; i < asset.count(); ++i)
 		{
-			for(int i = 0; i < BUFFER_SIZE; ++i)
+			const SkeletonAssetBone& entry = asset.getBone(i);
+			Bone* bone = NULL;
+			if(entry.parent < 0)
 			{
-				buffer[i] = NULL;
+				root = Bone(entry.x,entry.y,entry.angle,entry.length,
+					entry.minAngle,entry.maxAngle,entry.relative == 1,"ROOT");
+				root.setId(BoneId(0,boneSlots[0].generation));
+				bone = &root;
+			}
+			else
+			{
+				bone = add(entry.x,entry.y,entry.angle,entry.length,
+					entry.minAngle,entry.maxAngle,asset.getName(i),created[entry.parent]);
+				bone->setAsFixture(entry.fixture == 1);
+				if(entry.relative == 0)
+				{
+					bone->setRelative(false);
+				}
 			}
-			file.getline(buffer,BUFFER_SIZE - 1);
 
-			//comments are allowed
-			if(buffer[0] != '#' && strlen(buffer) > 2)
-			lines.push_back(buffer);
+			if(entry.keyFrameCount > 0)
+			{
+				const SkeletonAssetKeyFrame* keys = asset.getKeyFrames(i);
+				std::vector<KeyFrame> keyFrames;
+				keyFrames.reserve(entry.keyFrameCount);
+				for(uint32_t k = 0; k < entry.keyFrameCount; ++k)
+				{
+					keyFrames.push_back(KeyFrame(keys[k].value,keys[k].frame));
+				}
+				bone->addKeyFrames(keyFrames);
+			}
+			created[i] = bone;
 		}
 
-		file.close();
+		return true;
+	}
+
+	bool Skeleton::loadBinary( const std::string& fileName )
+	{
+		MappedFile file;
+		SkeletonAsset asset;
+		if(!file.open(fileName) || !asset.open(file.getData(),file.getSize()))
+		{
+			return false;
+		}
+
+		return load(asset);
+	}
+
+	bool Skeleton::saveBinary( const std::string& fileName )
+	{
+		return SkeletonAsset::save(*this,fileName);
+	}
+
+	const std::string& Skeleton::getLoadError() const
+	{
+		return loadError;
+	}
+
+	static const char* _skipSpaces( const char* it, const char* end )
+	{
+		while(it < end && (*it == ' ' || *it == '\t' || *it == '\r'))
+		{
+			++it;
+		}
+		return it;
+	}
+
+	static bool _readInt( const char*& it, const char* end, int& value )
+	{
+		it = _skipSpaces(it,end);
+		bool negative = it < end && *it == '-';
+		if(negative || (it < end && *it == '+'))
+		{
+			++it;
+		}
+		if(it == end || *it < '0' || *it > '9')
+		{
+			return false;
+		}
 
+		value = 0;
+		while(it < end && *it >= '0' && *it <= '9')
+		{
+			value = value * 10 + (*it - '0');
+			++it;
+		}
+		value = negative ? -value : value;
 		return true;
 	}
 
-	bool Skeleton::_sortLinesByLevel( std::vector<std::string>& lines,
-		std::vector<std::pair<int,std::string*> >& sortedList )
+	static bool _readFloat( const char*& it, const char* end, float& value )
 	{
-		std::stringstream ss;
+		//strtod needs a terminated string, copy the token into a small buffer
+		it = _skipSpaces(it,end);
+		char buffer[64];
+		int length = 0;
+		while(it + length < end && length < 63 && it[length] != ' ' &&
+			it[length] != '\t' && it[length] != '\r' && it[length] != '"')
+		{
+			buffer[length] = it[length];
+			length++;
+		}
+		buffer[length] = '\0';
+
+		char* parsed = NULL;
+		value = (float)strtod(buffer,&parsed);
+		if(length == 0 || parsed != buffer + length)
+		{
+			return false;
+		}
+		it += length;
+		return true;
+	}
+
+	static bool _readName( const char*& it, const char* end, const char*& name, size_t& length )
+	{
+		//Quoted, leading spaces inside the quotes are dropped like the old sscanf did
+		it = _skipSpaces(it,end);
+		if(it == end || *it != '"')
+		{
+			return false;
+		}
+		it = _skipSpaces(it + 1,end);
+		name = it;
+		while(it < end && *it != '"')
+		{
+			++it;
+		}
+		if(it == end)
+		{
+			return false;
+		}
+		length = it - name;
+		++it;
+		return true;
+	}
 
-		const int BUFFER_SIZE = 64;
-		char buffer[BUFFER_SIZE];
+	static unsigned int _hashName( const char* name, size_t length )
+	{
+		//FNV-1a
+		unsigned int hash = 2166136261u;
+		for(size_t i = 0; i < length; ++i)
+		{
+			hash = (hash ^ (unsigned char)name[i]) * 16777619u;
+		}
+		return hash;
+	}
 
-		for (std::vector<std::string>::iterator it = lines.begin();
-			it != lines.end(); ++it)
+	struct BoneLine
+	{
+		int line;
+		int level;
+		float x;
+		float y;
+		float angle;
+		float length;
+		float minAngle;
+		float maxAngle;
+		int relative;
+		int fixture;
+		const char* name;
+		size_t nameLength;
+		const char* parentName;
+		size_t parentNameLength;
+	};
+
+	bool Skeleton::parse( const char* text, size_t size )
+	{
+		loadError.clear();
+		std::vector<BoneLine> lines;
+		const char* end = text + size;
+		int lineNumber = 0;
+		int maxLevel = 0;
+
+		//Tokenize every line in place
+		for(const char* it = text; it < end; )
 		{
-			//clear buffer
-			for(int i = 0; i < BUFFER_SIZE; ++i)
+			const char* lineEnd = it;
+			while(lineEnd < end && *lineEnd != '\n')
 			{
-				buffer[i] = NULL;
+				++lineEnd;
 			}
+			lineNumber++;
+
+			const char* start = it;
+			it = lineEnd + 1;
 
-			//Do until space or end of string
-			for(int i = 0; (*it)[i] != ' ' && (*it)[i] != NULL && i < BUFFER_SIZE; ++i)
+			//Comments and near empty lines are allowed
+			if(*start == '#' || _skipSpaces(start,lineEnd) == lineEnd || lineEnd - start <= 2)
 			{
-				buffer[i] = (*it)[i];
+				continue;
 			}
 
-			ss.clear();
-			ss.str("");
+			BoneLine line;
+			line.line = lineNumber;
+			const char* cursor = start;
+			bool valid = _readInt(cursor,lineEnd,line.level) && line.level >= 0 &&
+				_readFloat(cursor,lineEnd,line.x) &&
+				_readFloat(cursor,lineEnd,line.y) &&
+				_readFloat(cursor,lineEnd,line.angle) &&
+				_readFloat(cursor,lineEnd,line.length) &&
+				_readFloat(cursor,lineEnd,line.minAngle) &&
+				_readFloat(cursor,lineEnd,line.maxAngle) &&
+				_readInt(cursor,lineEnd,line.relative);
+
+			//The fixture flag is optional, save() leaves it out for the root
+			line.fixture = 0;
+			const char* next = _skipSpaces(cursor,lineEnd);
+			if(valid && next < lineEnd && *next != '"')
+			{
+				valid = _readInt(cursor,lineEnd,line.fixture);
+			}
 
-			ss << buffer;
+			valid = valid &&
+				_readName(cursor,lineEnd,line.name,line.nameLength) &&
+				_readName(cursor,lineEnd,line.parentName,line.parentNameLength);
 
-			int level = 0;
-			ss >> level;
+			if(!valid)
+			{
+				std::stringstream ss;
+				ss << "line " << lineNumber << ": malformed bone";
+				loadError = ss.str();
+				return false;
+			}
 
-			//Add to list
-			sortedList.push_back(std::pair<int, std::string*>(level,&(*it) ));
+			maxLevel = line.level > maxLevel ? line.level : maxLevel;
+			lines.push_back(line);
 		}
 
-		std::sort(sortedList.begin(), sortedList.end());
-
-		return true;
-	}
+		//Stable counting sort by level, parents then come before children
+		std::vector<int> levelStarts(maxLevel + 2,0);
+		for(size_t i = 0; i < lines.size(); ++i)
+		{
+			levelStarts[lines[i].level + 1]++;
+		}
+		for(int level = 1; level <= maxLevel + 1; ++level)
+		{
+			levelStarts[level] += levelStarts[level - 1];
+		}
+		std::vector<int> order(lines.size());
+		for(size_t i = 0; i < lines.size(); ++i)
+		{
+			order[levelStarts[lines[i].level]++] = (int)i;
+		}
 
-	void Skeleton::_makeBonesFromSortedList( std::vector<std::pair<int,std::string*> >& sortedList )
-	{
 		root.clear();
 		bones.clear();
+		flatBonesValid = false;
+		_resetIds();
 
-		std::stringstream ss;
+		//Open addressing table from names in the buffer to created bones
+		size_t tableSize = 16;
+		while(tableSize < lines.size() * 2)
+		{
+			tableSize *= 2;
+		}
+		std::vector<int> table(tableSize,-1);
+		std::vector<Bone*> created(lines.size(),NULL);
 
-		int level = 0;
-		float x = 0;
-		float y = 0;
-		float angle = 0;
-		float length = 0;
-		float minAngle = 0;
-		float maxAngle = 0;
-		int relative = 0;
-		int fixture = 0;
-		char name[256];
-		char parentName[256];
-
-		Bone* parent = NULL;
-		Bone* child = NULL;
-		for( std::vector<std::pair<int,std::string*> >::iterator it = sortedList.begin();
-			it != sortedList.end(); ++it)
-		{
-			sscanf(it->second->c_str(),"%d %f %f %f %f %f %f %d %d \" %[^\"] \" \" %[^\"]",
-				&level, &x, &y, &angle, &length, &minAngle, &maxAngle, &relative, &fixture, name,parentName);
-
-			if(level == 1)
+		for(size_t i = 0; i < order.size(); ++i)
+		{
+			const BoneLine& line = lines[order[i]];
+			Bone* parent = NULL;
+			if(line.level == 0)
 			{
-				parent = &root;
+				root = Bone(line.x,line.y,line.angle,line.length,line.minAngle,line.maxAngle,
+					line.relative == 1,"ROOT");
+				root.setId(BoneId(0,boneSlots[0].generation));
+				continue;
 			}
-			else if(level == 0)
+			else if(line.level == 1)
 			{
-				parent = NULL;
+				parent = &root;
 			}
 			else
 			{
-				parent = getByName(parentName);
+				size_t slot = _hashName(line.parentName,line.parentNameLength) & (tableSize - 1);
+				while(table[slot] >= 0)
+				{
+					const BoneLine& other = lines[table[slot]];
+					if(other.nameLength == line.parentNameLength &&
+						memcmp(other.name,line.parentName,line.parentNameLength) == 0)
+					{
+						parent = created[table[slot]];
+						break;
+					}
+					slot = (slot + 1) & (tableSize - 1);
+				}
+			}
+
+			//Bones whose parent is missing are skipped, as before
+			if(!parent)
+			{
+				continue;
+			}
+
+			Bone* child = add(line.x,line.y,line.angle,line.length,line.minAngle,line.maxAngle,
+				std::string(line.name,line.nameLength),parent);
+			child->setAsFixture(line.fixture == 1);
+			if(line.relative == 0)
+			{
+				child->setRelative(false);
 			}
+			created[order[i]] = child;
 
-			if(parent)
+			//The first bone with a name is the one children attach to
+			size_t slot = _hashName(line.name,line.nameLength) & (tableSize - 1);
+			while(table[slot] >= 0)
 			{
-				child = add(x,y,angle,length,minAngle,maxAngle,name,parent);
-				child->setAsFixture(fixture == 1);
-				if(relative == 0 && child)
+				const BoneLine& other = lines[table[slot]];
+				if(other.nameLength == line.nameLength &&
+					memcmp(other.name,line.name,line.nameLength) == 0)
 				{
-					child->setRelative(false);
+					break;
 				}
+				slot = (slot + 1) & (tableSize - 1);
+			}
+			if(table[slot] < 0)
+			{
+				table[slot] = order[i];
+			}
+		}
+
+		return true;
+	}
+
+	int Skeleton::_replayJournal( const char* text, size_t size )
+	{
+		//Stops at the first bad line, a torn last write must not break loading
+		const char* end = text + size;
+		int applied = 0;
+		for(const char* it = text; it < end; )
+		{
+			const char* lineEnd = it;
+			while(lineEnd < end && *lineEnd != '\n')
+			{
+				++lineEnd;
+			}
+
+			const char* cursor = it;
+			it = lineEnd + 1;
+			if(_skipSpaces(cursor,lineEnd) == lineEnd)
+			{
+				continue;
+			}
+
+			const char* name = NULL;
+			size_t nameLength = 0;
+			if(!_readName(cursor,lineEnd,name,nameLength))
+			{
+				break;
 			}
-			else if(level == 0)
+
+			cursor = _skipSpaces(cursor,lineEnd);
+			const char* field = cursor;
+			while(cursor < lineEnd && *cursor != ' ')
+			{
+				++cursor;
+			}
+			std::string fieldName(field,cursor - field);
+
+			float value = 0.0f;
+			if(!_readFloat(cursor,lineEnd,value))
 			{
-				//Add root
-				root = Bone(x,y,angle,length,minAngle,maxAngle,relative == 1,"ROOT");
+				break;
 			}
+
+			std::string boneName(name,nameLength);
+			Bone* bone = boneName == root.getName() ? &root : getByName(boneName);
+			if(!bone)
+			{
+				continue;
+			}
+
+			if(fieldName == "x")
+				bone->setX(value);
+			else if(fieldName == "y")
+				bone->setY(value);
+			else if(fieldName == "angle")
+				bone->setAngle(value);
+			else if(fieldName == "length")
+				bone->setLength(value);
+			else if(fieldName == "minAngle")
+				bone->setMinAngle(value);
+			else if(fieldName == "maxAngle")
+				bone->setMaxAngle(value);
+			else if(fieldName == "relative")
+				bone->setRelative(value != 0.0f);
+			else if(fieldName == "fixture")
+				bone->setAsFixture(value != 0.0f);
+			else
+				break;
+
+			applied++;
 		}
+
+		return applied;
 	}
 
 	void Skeleton::setPosition( float x, float y )
@@ -458,15 +999,18 @@ namespace skl
 
 	void Skeleton::renameBone( const std::string& oldName, const std::string& newName )
 	{
-		if(!contains(oldName))
+		std::map<std::string,Bone*>::iterator it = bones.find(oldName);
+		if(it == bones.end())
 		{
 			return;
 		}
 
-		Bone* bone = bones[oldName];
-		bones.erase(oldName);
+		Bone* bone = it->second;
+		bones.erase(it);
 
-		std::string actualName = newName;
+		//setName replaces quotes, so check and key the name it actually keeps
+		bone->setName(newName);
+		std::string actualName = bone->getName();
 		int count = 0;
 		while(contains(actualName) && count < 10)
 		{
@@ -474,7 +1018,8 @@ namespace skl
 		}
 
 		bone->setName(actualName);
-		bones[bone->getName()] = bone;
+		boneSlots[bone->getId().getIndex()].entry =
+			bones.insert(std::make_pair(bone->getName(),bone)).first;
 	}
 
 	void Skeleton::renameBone( Bone* bone, const std::string& newName )
@@ -495,6 +1040,110 @@ namespace skl
 	{
 		_processAnimation(&root);
 	}
+
+	void Skeleton::_sampleAnimation( Bone* root, float frame )
+	{
+		root->sampleAnimation(frame);
+		for(std::list<Bone>::iterator it = root->begin(); it != root->end(); ++it)
+		{
+			_sampleAnimation(&(*it),frame);
+		}
+	}
+
+	void Skeleton::sampleAnimation( float time, float framesPerSecond )
+	{
+		//time is in seconds, scale it for other playback rates
+		_sampleAnimation(&root,time * framesPerSecond);
+	}
+
+	size_t Skeleton::_getAnimationLength( Bone* root )
+	{
+		size_t length = 0;
+		if(!root->getKeyFrames().empty())
+		{
+			length = root->getKeyFrames().back().getFrame();
+		}
+
+		for(std::list<Bone>::iterator it = root->begin(); it != root->end(); ++it)
+		{
+			size_t childLength = _getAnimationLength(&(*it));
+			if(childLength > length)
+			{
+				length = childLength;
+			}
+		}
+		return length;
+	}
+
+	size_t Skeleton::getAnimationLength()
+	{
+		return _getAnimationLength(&root);
+	}
+
+	float Skeleton::_getReach( Bone* root )
+	{
+		//Farthest distance from the bone's pivot to anything that turns with it
+		float reach = root->getLength();
+		for(std::list<Bone>::iterator it = root->begin(); it != root->end(); ++it)
+		{
+			if(!it->isRelative())
+			{
+				continue;
+			}
+
+			float childReach = root->getLength() +
+				sqrt(it->getX() * it->getX() + it->getY() * it->getY()) +
+				_getReach(&(*it));
+			reach = childReach > reach ? childReach : reach;
+		}
+		return reach;
+	}
+
+	int Skeleton::_getDepth( Bone* root )
+	{
+		int depth = 0;
+		for(std::list<Bone>::iterator it = root->begin(); it != root->end(); ++it)
+		{
+			int childDepth = _getDepth(&(*it));
+			depth = childDepth > depth ? childDepth : depth;
+		}
+		return depth + 1;
+	}
+
+	void Skeleton::_reduceKeyFrames( Bone* root, float tolerance, float parentError,
+		KeyFrameReduction& total )
+	{
+		float reach = _getReach(root);
+		KeyFrameReduction reduction = root->reduceKeyFrames(reach > 0.0f ? tolerance / reach : tolerance);
+		total.originalCount += reduction.originalCount;
+		total.reducedCount += reduction.reducedCount;
+
+		//Bones that ignore their parent do not inherit its error
+		float error = reduction.maxError * reach + (root->isRelative() ? parentError : 0.0f);
+		if(error > total.maxError)
+		{
+			total.maxError = error;
+		}
+
+		for(std::list<Bone>::iterator it = root->begin(); it != root->end(); ++it)
+		{
+			_reduceKeyFrames(&(*it),tolerance,error,total);
+		}
+	}
+
+	KeyFrameReduction Skeleton::reduceKeyFrames( float worldTolerance )
+	{
+		//An angle error moves the bone's subtree by at most error * reach, and
+		//errors of every bone along a chain add up, so each bone gets an equal
+		//share of the tolerance. ROOT's keys are reduced too, so it counts as
+		//a level. maxError is in world units.
+		KeyFrameReduction total;
+		total.originalCount = 0;
+		total.reducedCount = 0;
+		total.maxError = 0.0f;
+		_reduceKeyFrames(&root,worldTolerance / _getDepth(&root),0.0f,total);
+		return total;
+	}
 }
 
 
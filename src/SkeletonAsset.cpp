@@ -0,0 +1,210 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "SKALE/SkeletonAsset.hpp"
+#include "SKALE/Skeleton.hpp"
+#include <fstream>
+#include <string.h>
+
+namespace skl
+{
+	SkeletonAsset::SkeletonAsset(void)
+		: mData(NULL), mHeader(NULL), mBones(NULL), mKeyFrames(NULL), mStrings(NULL)
+	{
+	}
+
+	SkeletonAsset::~SkeletonAsset(void)
+	{
+	}
+
+	static bool _fits( uint32_t offset, uint64_t size, uint32_t fileSize )
+	{
+		return offset % 4 == 0 && (uint64_t)offset + size <= fileSize;
+	}
+
+	bool SkeletonAsset::open( const void* data, size_t size )
+	{
+		//Check every offset once here so the accessors can trust them
+		mData = NULL;
+		const SkeletonAssetHeader* header = (const SkeletonAssetHeader*)data;
+		if(!data || size < sizeof(SkeletonAssetHeader) ||
+			memcmp(header->magic,SK_ASSET_MAGIC,4) != 0 ||
+			header->version != SK_ASSET_VERSION ||
+			header->fileSize > size || header->boneCount == 0 ||
+			!_fits(header->bonesOffset,(uint64_t)header->boneCount * sizeof(SkeletonAssetBone),header->fileSize) ||
+			!_fits(header->keyFramesOffset,(uint64_t)header->keyFrameCount * sizeof(SkeletonAssetKeyFrame),header->fileSize) ||
+			!_fits(header->stringsOffset,header->stringsSize,header->fileSize) ||
+			header->stringsSize == 0)
+		{
+			return false;
+		}
+
+		const char* bytes = (const char*)data;
+		const SkeletonAssetBone* bones = (const SkeletonAssetBone*)(bytes + header->bonesOffset);
+		const char* strings = bytes + header->stringsOffset;
+		if(strings[header->stringsSize - 1] != '\0')
+		{
+			return false;
+		}
+
+		for(uint32_t i = 0; i < header->boneCount; ++i)
+		{
+			const SkeletonAssetBone& bone = bones[i];
+			bool parentValid = i == 0 ? bone.parent == -1 : bone.parent >= 0 && (uint32_t)bone.parent < i;
+			if(!parentValid || bone.name >= header->stringsSize ||
+				(uint64_t)bone.firstKeyFrame + bone.keyFrameCount > header->keyFrameCount)
+			{
+				return false;
+			}
+		}
+
+		mData = bytes;
+		mHeader = header;
+		mBones = bones;
+		mKeyFrames = (const SkeletonAssetKeyFrame*)(bytes + header->keyFramesOffset);
+		mStrings = strings;
+		return true;
+	}
+
+	bool SkeletonAsset::isOpen() const
+	{
+		return mData != NULL;
+	}
+
+	int SkeletonAsset::count() const
+	{
+		return mData ? (int)mHeader->boneCount : 0;
+	}
+
+	const SkeletonAssetBone& SkeletonAsset::getBone( int index ) const
+	{
+		return mBones[index];
+	}
+
+	const char* SkeletonAsset::getName( int index ) const
+	{
+		return mStrings + mBones[index].name;
+	}
+
+	const SkeletonAssetKeyFrame* SkeletonAsset::getKeyFrames( int index ) const
+	{
+		return mKeyFrames + mBones[index].firstKeyFrame;
+	}
+
+	bool SkeletonAsset::write( Skeleton& skeleton, std::vector<char>& data )
+	{
+		const FlatSkeleton& flat = skeleton.getFlatBones();
+		int n = flat.count();
+		if(n == 0)
+		{
+			return false;
+		}
+
+		std::vector<SkeletonAssetBone> bones(n);
+		std::vector<SkeletonAssetKeyFrame> keyFrames;
+		std::string strings;
+		for(int i = 0; i < n; ++i)
+		{
+			const Bone* bone = flat.getBone(i);
+			SkeletonAssetBone& entry = bones[i];
+			entry.parent = flat.getParentIndex(i);
+			entry.name = (uint32_t)strings.size();
+			entry.x = bone->getX();
+			entry.y = bone->getY();
+			entry.angle = bone->getAngle();
+			entry.length = bone->getLength();
+			entry.minAngle = bone->getMinAngle();
+			entry.maxAngle = bone->getMaxAngle();
+			entry.relative = bone->isRelative() ? 1 : 0;
+			entry.fixture = bone->isFixture() ? 1 : 0;
+			entry.reserved = 0;
+			entry.firstKeyFrame = (uint32_t)keyFrames.size();
+			entry.keyFrameCount = (uint32_t)bone->getKeyFrames().size();
+
+			strings += bone->getName();
+			strings += '\0';
+
+			const std::vector<KeyFrame>& boneKeys = bone->getKeyFrames();
+			for(size_t k = 0; k < boneKeys.size(); ++k)
+			{
+				SkeletonAssetKeyFrame key;
+				key.frame = (uint32_t)boneKeys[k].getFrame();
+				key.value = boneKeys[k].getValue();
+				keyFrames.push_back(key);
+			}
+		}
+
+		//Pad the string table so the file size stays aligned
+		while(strings.size() % 4 != 0)
+		{
+			strings += '\0';
+		}
+
+		SkeletonAssetHeader header;
+		memcpy(header.magic,SK_ASSET_MAGIC,4);
+		header.version = SK_ASSET_VERSION;
+		header.boneCount = (uint32_t)n;
+		header.bonesOffset = sizeof(SkeletonAssetHeader);
+		header.keyFrameCount = (uint32_t)keyFrames.size();
+		header.keyFramesOffset = header.bonesOffset + n * sizeof(SkeletonAssetBone);
+		header.stringsSize = (uint32_t)strings.size();
+		header.stringsOffset = header.keyFramesOffset + (uint32_t)(keyFrames.size() * sizeof(SkeletonAssetKeyFrame));
+		header.fileSize = header.stringsOffset + header.stringsSize;
+
+		data.resize(header.fileSize);
+		memcpy(&data[0],&header,sizeof(header));
+		memcpy(&data[header.bonesOffset],&bones[0],n * sizeof(SkeletonAssetBone));
+		if(!keyFrames.empty())
+		{
+			memcpy(&data[header.keyFramesOffset],&keyFrames[0],keyFrames.size() * sizeof(SkeletonAssetKeyFrame));
+		}
+		memcpy(&data[header.stringsOffset],strings.data(),strings.size());
+		return true;
+	}
+
+	bool SkeletonAsset::save( Skeleton& skeleton, const std::string& fileName )
+	{
+		std::vector<char> data;
+		if(!write(skeleton,data))
+		{
+			return false;
+		}
+
+		std::ofstream file(fileName.c_str(),std::ios::out | std::ios::binary);
+		if(!file.is_open())
+		{
+			return false;
+		}
+
+		file.write(&data[0],data.size());
+		file.close();
+		return !file.fail();
+	}
+}
@@ -0,0 +1,136 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "SKALE/SkeletonBatch.hpp"
+#include "SKALE/Skeleton.hpp"
+#include "SKALE/SkeletonInstance.hpp"
+#include <algorithm>
+
+namespace skl
+{
+	SkeletonBatch::SkeletonBatch( ThreadPool* pool )
+		: mPool(pool), mGrainSize(0)
+	{
+	}
+
+	SkeletonBatch::~SkeletonBatch(void)
+	{
+	}
+
+	void SkeletonBatch::add( Skeleton* skeleton )
+	{
+		mSkeletons.push_back(skeleton);
+	}
+
+	void SkeletonBatch::add( SkeletonInstance* instance )
+	{
+		mInstances.push_back(instance);
+	}
+
+	bool SkeletonBatch::remove( Skeleton* skeleton )
+	{
+		std::vector<Skeleton*>::iterator it =
+			std::find(mSkeletons.begin(),mSkeletons.end(),skeleton);
+		if(it == mSkeletons.end())
+		{
+			return false;
+		}
+
+		mSkeletons.erase(it);
+		return true;
+	}
+
+	bool SkeletonBatch::remove( SkeletonInstance* instance )
+	{
+		std::vector<SkeletonInstance*>::iterator it =
+			std::find(mInstances.begin(),mInstances.end(),instance);
+		if(it == mInstances.end())
+		{
+			return false;
+		}
+
+		mInstances.erase(it);
+		return true;
+	}
+
+	void SkeletonBatch::clear()
+	{
+		mSkeletons.clear();
+		mInstances.clear();
+	}
+
+	int SkeletonBatch::count() const
+	{
+		return (int)(mSkeletons.size() + mInstances.size());
+	}
+
+	void SkeletonBatch::setGrainSize( size_t grainSize )
+	{
+		mGrainSize = grainSize;
+	}
+
+	size_t SkeletonBatch::getGrainSize() const
+	{
+		return mGrainSize;
+	}
+
+	void SkeletonBatch::update()
+	{
+		if(!mPool)
+		{
+			_updateSkeletons(0,mSkeletons.size(),this);
+			_updateInstances(0,mInstances.size(),this);
+			return;
+		}
+
+		//A grain size of 0 lets the pool pick one from its thread count
+		mPool->parallelFor(mSkeletons.size(),mGrainSize,&SkeletonBatch::_updateSkeletons,this);
+		mPool->parallelFor(mInstances.size(),mGrainSize,&SkeletonBatch::_updateInstances,this);
+	}
+
+	void SkeletonBatch::_updateSkeletons( size_t first, size_t last, void* userData )
+	{
+		SkeletonBatch* batch = (SkeletonBatch*)userData;
+		for(size_t i = first; i < last; ++i)
+		{
+			batch->mSkeletons[i]->processAnimation();
+			batch->mSkeletons[i]->updateBones();
+		}
+	}
+
+	void SkeletonBatch::_updateInstances( size_t first, size_t last, void* userData )
+	{
+		SkeletonBatch* batch = (SkeletonBatch*)userData;
+		for(size_t i = first; i < last; ++i)
+		{
+			batch->mInstances[i]->updateBones();
+		}
+	}
+}
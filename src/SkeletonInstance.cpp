@@ -0,0 +1,245 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "SKALE/SkeletonInstance.hpp"
+#include "SKALE/FlatSkeleton.hpp"
+#include <string.h>
+
+namespace skl
+{
+	//Layout of mData, each channel holds one float per bone
+	enum
+	{
+		CHANNEL_X,
+		CHANNEL_Y,
+		CHANNEL_ANGLE,
+		CHANNEL_LENGTH,
+		CHANNEL_FRAME_X,
+		CHANNEL_FRAME_Y,
+		CHANNEL_FRAME_ANGLE,
+		CHANNEL_COUNT
+	};
+
+	SkeletonInstance::SkeletonInstance( const Rig* rig )
+		: mRig(rig), mData(NULL)
+	{
+		if(count() > 0)
+		{
+			mData = new float[count() * CHANNEL_COUNT];
+			memset(mData,0,sizeof(float) * count() * CHANNEL_COUNT);
+		}
+		resetPose();
+	}
+
+	SkeletonInstance::SkeletonInstance( const SkeletonInstance& other )
+		: mRig(other.mRig), mData(NULL)
+	{
+		if(count() > 0)
+		{
+			mData = new float[count() * CHANNEL_COUNT];
+			memcpy(mData,other.mData,sizeof(float) * count() * CHANNEL_COUNT);
+		}
+	}
+
+	SkeletonInstance& SkeletonInstance::operator=( const SkeletonInstance& other )
+	{
+		if(this == &other)
+		{
+			return *this;
+		}
+
+		if(count() != other.count())
+		{
+			delete[] mData;
+			mData = other.count() > 0 ? new float[other.count() * CHANNEL_COUNT] : NULL;
+		}
+
+		mRig = other.mRig;
+		if(mData)
+		{
+			memcpy(mData,other.mData,sizeof(float) * count() * CHANNEL_COUNT);
+		}
+
+		return *this;
+	}
+
+	SkeletonInstance::~SkeletonInstance(void)
+	{
+		delete[] mData;
+	}
+
+	float* SkeletonInstance::_channel( int channel ) const
+	{
+		return mData + channel * count();
+	}
+
+	const Rig* SkeletonInstance::getRig() const
+	{
+		return mRig;
+	}
+
+	int SkeletonInstance::count() const
+	{
+		return mRig ? mRig->count() : 0;
+	}
+
+	void SkeletonInstance::resetPose()
+	{
+		if(!mData)
+		{
+			return;
+		}
+
+		size_t size = sizeof(float) * count();
+		memcpy(_channel(CHANNEL_X),mRig->getRestX(),size);
+		memcpy(_channel(CHANNEL_Y),mRig->getRestY(),size);
+		memcpy(_channel(CHANNEL_ANGLE),mRig->getRestAngle(),size);
+		memcpy(_channel(CHANNEL_LENGTH),mRig->getRestLength(),size);
+	}
+
+	void SkeletonInstance::setPosition( float x, float y )
+	{
+		setX(0,x);
+		setY(0,y);
+	}
+
+	void SkeletonInstance::setAngle( int index, float angle )
+	{
+		_channel(CHANNEL_ANGLE)[index] = angle;
+	}
+
+	void SkeletonInstance::setX( int index, float x )
+	{
+		_channel(CHANNEL_X)[index] = x;
+	}
+
+	void SkeletonInstance::setY( int index, float y )
+	{
+		_channel(CHANNEL_Y)[index] = y;
+	}
+
+	void SkeletonInstance::setLength( int index, float length )
+	{
+		_channel(CHANNEL_LENGTH)[index] = length < 0.0f ? -length : length;
+	}
+
+	float* SkeletonInstance::getX()
+	{
+		return _channel(CHANNEL_X);
+	}
+
+	float* SkeletonInstance::getY()
+	{
+		return _channel(CHANNEL_Y);
+	}
+
+	float* SkeletonInstance::getAngle()
+	{
+		return _channel(CHANNEL_ANGLE);
+	}
+
+	float* SkeletonInstance::getLength()
+	{
+		return _channel(CHANNEL_LENGTH);
+	}
+
+	const float* SkeletonInstance::getX() const
+	{
+		return _channel(CHANNEL_X);
+	}
+
+	const float* SkeletonInstance::getY() const
+	{
+		return _channel(CHANNEL_Y);
+	}
+
+	const float* SkeletonInstance::getAngle() const
+	{
+		return _channel(CHANNEL_ANGLE);
+	}
+
+	const float* SkeletonInstance::getLength() const
+	{
+		return _channel(CHANNEL_LENGTH);
+	}
+
+	void SkeletonInstance::updateBones()
+	{
+		if(!mData)
+		{
+			return;
+		}
+
+		updateFrames(mRig->getParents(),mRig->getRelativeFlags(),
+			_channel(CHANNEL_X),_channel(CHANNEL_Y),
+			_channel(CHANNEL_ANGLE),_channel(CHANNEL_LENGTH),
+			_channel(CHANNEL_FRAME_X),_channel(CHANNEL_FRAME_Y),
+			_channel(CHANNEL_FRAME_ANGLE),0,count());
+	}
+
+	void SkeletonInstance::updateBones( int index )
+	{
+		updateFrames(mRig->getParents(),mRig->getRelativeFlags(),
+			_channel(CHANNEL_X),_channel(CHANNEL_Y),
+			_channel(CHANNEL_ANGLE),_channel(CHANNEL_LENGTH),
+			_channel(CHANNEL_FRAME_X),_channel(CHANNEL_FRAME_Y),
+			_channel(CHANNEL_FRAME_ANGLE),index,mRig->getSubtreeEnd(index));
+	}
+
+	const float& SkeletonInstance::getFrameX( int index ) const
+	{
+		return _channel(CHANNEL_FRAME_X)[index];
+	}
+
+	const float& SkeletonInstance::getFrameY( int index ) const
+	{
+		return _channel(CHANNEL_FRAME_Y)[index];
+	}
+
+	const float& SkeletonInstance::getFrameAngle( int index ) const
+	{
+		return _channel(CHANNEL_FRAME_ANGLE)[index];
+	}
+
+	const float* SkeletonInstance::getFrameX() const
+	{
+		return _channel(CHANNEL_FRAME_X);
+	}
+
+	const float* SkeletonInstance::getFrameY() const
+	{
+		return _channel(CHANNEL_FRAME_Y);
+	}
+
+	const float* SkeletonInstance::getFrameAngle() const
+	{
+		return _channel(CHANNEL_FRAME_ANGLE);
+	}
+}
@@ -0,0 +1,258 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "SKALE/SkeletonJournal.hpp"
+#include "SKALE/Skeleton.hpp"
+#include <stdio.h>
+#include <iterator>
+
+namespace skl
+{
+	static bool _readFile( const std::string& fileName, std::string& text )
+	{
+		std::ifstream file(fileName.c_str(),std::ios::in | std::ios::binary);
+		if(!file.is_open())
+		{
+			return false;
+		}
+
+		text.assign((std::istreambuf_iterator<char>(file)),std::istreambuf_iterator<char>());
+		return true;
+	}
+
+	SkeletonJournal::SkeletonJournal( Skeleton* skeleton, const std::string& fileName )
+		: mSkeleton(skeleton), mFileName(fileName), mEntries(0), mCompactThreshold(1000),
+		mSaveCount(skeleton->getSaveCount())
+	{
+		//The skeleton is assumed to match the file and its journal, as after
+		//load. A journal with a stale stamp was not replayed, so drop it.
+		std::string base;
+		std::string journal;
+		if(!_readFile(fileName,base))
+		{
+			checkpoint();
+			return;
+		}
+
+		std::string header = getHeader(base.data(),base.size());
+		if(_readFile(getJournalName(fileName),journal) &&
+			journal.compare(0,header.size(),header) == 0)
+		{
+			mJournal.open(getJournalName(fileName).c_str(),
+				std::ios::out | std::ios::app | std::ios::binary);
+		}
+		else
+		{
+			_stamp();
+		}
+		_snapshot();
+	}
+
+	SkeletonJournal::~SkeletonJournal(void)
+	{
+		mJournal.close();
+	}
+
+	std::string SkeletonJournal::getJournalName( const std::string& fileName )
+	{
+		return fileName + ".journal";
+	}
+
+	const char* SkeletonJournal::getFieldName( int field )
+	{
+		static const char* names[FIELD_COUNT] =
+		{
+			"x", "y", "angle", "length", "minAngle", "maxAngle", "relative", "fixture"
+		};
+		return field >= 0 && field < FIELD_COUNT ? names[field] : NULL;
+	}
+
+	std::string SkeletonJournal::getHeader( const char* text, size_t size )
+	{
+		//FNV-1a of the whole saved file
+		unsigned int hash = 2166136261u;
+		for(size_t i = 0; i < size; ++i)
+		{
+			hash = (hash ^ (unsigned char)text[i]) * 16777619u;
+		}
+
+		char header[32];
+		snprintf(header,sizeof(header),"#stamp %08x\n",hash);
+		return header;
+	}
+
+	bool SkeletonJournal::_stamp()
+	{
+		//Start an empty journal for the file as it is on disk now
+		mJournal.close();
+		std::string base;
+		if(!_readFile(mFileName,base))
+		{
+			return false;
+		}
+
+		std::string header = getHeader(base.data(),base.size());
+		mJournal.clear();
+		mJournal.open(getJournalName(mFileName).c_str(),
+			std::ios::out | std::ios::trunc | std::ios::binary);
+		mJournal.write(header.data(),header.size());
+		mJournal.flush();
+		mEntries = 0;
+		mSaveCount = mSkeleton->getSaveCount();
+		return !mJournal.fail();
+	}
+
+	void SkeletonJournal::_readFields( const Bone* bone, float* fields ) const
+	{
+		fields[FIELD_X] = bone->getX();
+		fields[FIELD_Y] = bone->getY();
+		fields[FIELD_ANGLE] = bone->getAngle();
+		fields[FIELD_LENGTH] = bone->getLength();
+		fields[FIELD_MIN_ANGLE] = bone->getMinAngle();
+		fields[FIELD_MAX_ANGLE] = bone->getMaxAngle();
+		fields[FIELD_RELATIVE] = bone->isRelative() ? 1.0f : 0.0f;
+		fields[FIELD_FIXTURE] = bone->isFixture() ? 1.0f : 0.0f;
+	}
+
+	void SkeletonJournal::_snapshot()
+	{
+		const FlatSkeleton& flat = mSkeleton->getFlatBones();
+		int n = flat.count();
+		mBones.resize(n);
+		mNames.resize(n);
+		mValues.resize(n * FIELD_COUNT);
+		for(int i = 0; i < n; ++i)
+		{
+			mBones[i] = flat.getBone(i);
+			mNames[i] = mBones[i]->getName();
+			_readFields(mBones[i],&mValues[i * FIELD_COUNT]);
+		}
+	}
+
+	bool SkeletonJournal::_isSameHierarchy()
+	{
+		const FlatSkeleton& flat = mSkeleton->getFlatBones();
+		if(flat.count() != (int)mBones.size())
+		{
+			return false;
+		}
+
+		for(int i = 0; i < flat.count(); ++i)
+		{
+			if(flat.getBone(i) != mBones[i] || flat.getBone(i)->getName() != mNames[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool SkeletonJournal::checkpoint()
+	{
+		//save() swaps the file in whole and removes the old journal. If a crash
+		//leaves the old journal behind, its stamp no longer matches the file.
+		mJournal.close();
+		if(!mSkeleton->save(mFileName))
+		{
+			return false;
+		}
+
+		bool stamped = _stamp();
+		_snapshot();
+		return stamped;
+	}
+
+	int SkeletonJournal::record()
+	{
+		//Bones were added, removed or renamed, only a full save describes that.
+		//The same goes for a save made behind the journal's back.
+		if(!_isSameHierarchy() || mEntries >= mCompactThreshold ||
+			mSkeleton->getSaveCount() != mSaveCount)
+		{
+			return checkpoint() ? 0 : -1;
+		}
+
+		mBuffer.clear();
+		int written = 0;
+		float fields[FIELD_COUNT];
+		char value[32];
+		for(size_t i = 0; i < mBones.size(); ++i)
+		{
+			_readFields(mBones[i],fields);
+			float* last = &mValues[i * FIELD_COUNT];
+			for(int f = 0; f < FIELD_COUNT; ++f)
+			{
+				if(fields[f] == last[f])
+				{
+					continue;
+				}
+
+				snprintf(value,sizeof(value),"%.9g",fields[f]);
+				mBuffer += '"';
+				mBuffer += mNames[i];
+				mBuffer += "\" ";
+				mBuffer += getFieldName(f);
+				mBuffer += ' ';
+				mBuffer += value;
+				mBuffer += '\n';
+				last[f] = fields[f];
+				written++;
+			}
+		}
+
+		if(written > 0)
+		{
+			mJournal.write(mBuffer.data(),mBuffer.size());
+			mJournal.flush();
+			mEntries += written;
+			if(mJournal.fail())
+			{
+				return -1;
+			}
+		}
+
+		return written;
+	}
+
+	size_t SkeletonJournal::getEntryCount() const
+	{
+		return mEntries;
+	}
+
+	void SkeletonJournal::setCompactThreshold( size_t entries )
+	{
+		mCompactThreshold = entries;
+	}
+
+	size_t SkeletonJournal::getCompactThreshold() const
+	{
+		return mCompactThreshold;
+	}
+}
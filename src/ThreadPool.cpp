@@ -0,0 +1,220 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "SKALE/ThreadPool.hpp"
+#include <algorithm>
+
+namespace skl
+{
+	ThreadPool::ThreadPool( size_t threadCount /*= 0*/ )
+		: mFunction(NULL), mUserData(NULL), mPendingRanges(0),
+		mActiveWorkers(0), mGeneration(0), mQuit(false)
+	{
+		if(threadCount == 0)
+		{
+			threadCount = std::thread::hardware_concurrency();
+		}
+
+		if(threadCount == 0)
+		{
+			threadCount = 1;
+		}
+
+		//Queue 0 belongs to the thread calling parallelFor
+		for(size_t i = 0; i < threadCount; ++i)
+		{
+			mQueues.push_back(new WorkQueue());
+		}
+
+		for(size_t i = 1; i < threadCount; ++i)
+		{
+			mThreads.push_back(std::thread(&ThreadPool::_workerLoop,this,i));
+		}
+	}
+
+	ThreadPool::~ThreadPool(void)
+	{
+		{
+			std::lock_guard<std::mutex> guard(mLock);
+			mQuit = true;
+		}
+		mWake.notify_all();
+
+		for(size_t i = 0; i < mThreads.size(); ++i)
+		{
+			mThreads[i].join();
+		}
+
+		for(size_t i = 0; i < mQueues.size(); ++i)
+		{
+			delete mQueues[i];
+		}
+	}
+
+	size_t ThreadPool::getThreadCount() const
+	{
+		return mQueues.size();
+	}
+
+	size_t ThreadPool::getGrainSize( size_t count ) const
+	{
+		//A few ranges per thread leaves room for stealing
+		//without paying for many tiny ranges.
+		size_t grain = count / (getThreadCount() * 4);
+		return grain > 0 ? grain : 1;
+	}
+
+	void ThreadPool::parallelFor( size_t count, size_t grainSize,
+		RangeFunction function, void* userData )
+	{
+		if(count == 0)
+		{
+			return;
+		}
+
+		if(grainSize == 0)
+		{
+			grainSize = getGrainSize(count);
+		}
+
+		if(mThreads.empty() || count <= grainSize)
+		{
+			function(0,count,userData);
+			return;
+		}
+
+		//Hand each queue a contiguous block of ranges
+		size_t rangeCount = (count + grainSize - 1) / grainSize;
+		for(size_t i = 0; i < rangeCount; ++i)
+		{
+			Range range;
+			range.first = i * grainSize;
+			range.last = std::min(count,range.first + grainSize);
+
+			WorkQueue* queue = mQueues[(i * mQueues.size()) / rangeCount];
+			std::lock_guard<std::mutex> guard(queue->lock);
+			queue->ranges.push_back(range);
+		}
+
+		{
+			std::lock_guard<std::mutex> guard(mLock);
+			mFunction = function;
+			mUserData = userData;
+			mPendingRanges = rangeCount;
+			mActiveWorkers = mThreads.size();
+			mGeneration++;
+		}
+		mWake.notify_all();
+
+		_runRanges(0);
+
+		std::unique_lock<std::mutex> lock(mLock);
+		while(mActiveWorkers > 0)
+		{
+			mFinished.wait(lock);
+		}
+	}
+
+	void ThreadPool::_workerLoop( size_t queueIndex )
+	{
+		unsigned int generation = 0;
+
+		while(true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(mLock);
+				while(!mQuit && generation == mGeneration)
+				{
+					mWake.wait(lock);
+				}
+
+				if(mQuit)
+				{
+					return;
+				}
+
+				generation = mGeneration;
+			}
+
+			_runRanges(queueIndex);
+
+			std::lock_guard<std::mutex> guard(mLock);
+			if(--mActiveWorkers == 0)
+			{
+				mFinished.notify_all();
+			}
+		}
+	}
+
+	void ThreadPool::_runRanges( size_t queueIndex )
+	{
+		Range range;
+		while(_popRange(queueIndex,range))
+		{
+			mFunction(range.first,range.last,mUserData);
+		}
+	}
+
+	bool ThreadPool::_popRange( size_t queueIndex, Range& range )
+	{
+		if(mPendingRanges == 0)
+		{
+			return false;
+		}
+
+		//Own work from the front, stolen work from the back of other queues
+		for(size_t i = 0; i < mQueues.size(); ++i)
+		{
+			WorkQueue* queue = mQueues[(queueIndex + i) % mQueues.size()];
+			std::lock_guard<std::mutex> guard(queue->lock);
+
+			if(queue->ranges.empty())
+			{
+				continue;
+			}
+
+			if(i == 0)
+			{
+				range = queue->ranges.front();
+				queue->ranges.pop_front();
+			}
+			else
+			{
+				range = queue->ranges.back();
+				queue->ranges.pop_back();
+			}
+
+			mPendingRanges--;
+			return true;
+		}
+
+		return false;
+	}
+}
@@ -0,0 +1,140 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//Checks that SimdIKSolver stays within its documented tolerance of IKSolver.
+//Run from the repository root, or pass the path of a skeleton file.
+#include "SKALE/Skeleton.hpp"
+#include "SKALE/SimdIKSolver.hpp"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+static const float TOLERANCE = 0.01f;
+static const int LANES = 64;
+static const int ROUNDS = 240;
+
+static float distanceTo( const skl::Bone* bone, float x, float y )
+{
+	return sqrt((bone->getFrameX() - x) * (bone->getFrameX() - x) +
+		(bone->getFrameY() - y) * (bone->getFrameY() - y));
+}
+
+int main(int argc, char* argv[])
+{
+	const char* fileName = argc > 1 ? argv[1] : "example/Skeleton.txt";
+	const char* effectors[] = { "LFoot", "LArm", "Neck", "RShin", "RFoot", "RArm",
+		"LShin", "Left Leg", "RLeg", "LShoulder", "RShoulder", "Pelvis" };
+	const int effectorCount = sizeof(effectors) / sizeof(effectors[0]);
+
+	skl::IKSolver scalar;
+	scalar.setAnalyticTwoBone(false);
+	skl::SimdIKSolver simd;
+	float radius = sqrt(scalar.getSolvedRadiusSquared());
+
+	//Reloaded every round, Skeleton is not copyable
+	static skl::Skeleton a[LANES];
+	static skl::Skeleton b[LANES];
+
+	srand(1);
+	int failures = 0;
+	int boundaryCases = 0;
+	float worst = 0.0f;
+	for(int round = 0; round < ROUNDS; ++round)
+	{
+		std::vector<skl::Skeleton*> skeletons(LANES);
+		std::vector<skl::Bone*> bones(LANES);
+		std::vector<float> targetX(LANES);
+		std::vector<float> targetY(LANES);
+		bool solved[LANES];
+
+		//Same random pose in both copies, random target around the effector
+		for(int i = 0; i < LANES; ++i)
+		{
+			if(!a[i].load(fileName) || !b[i].load(fileName))
+			{
+				printf("cannot load %s\n",fileName);
+				return 1;
+			}
+
+			const skl::FlatSkeleton& flatA = a[i].getFlatBones();
+			const skl::FlatSkeleton& flatB = b[i].getFlatBones();
+			for(int k = 1; k < flatA.count(); ++k)
+			{
+				float angle = (rand() % 6283) / 1000.0f - 3.14f;
+				flatA.getBone(k)->setAngle(angle);
+				flatB.getBone(k)->setAngle(angle);
+			}
+			a[i].updateBones();
+			b[i].updateBones();
+
+			skeletons[i] = &b[i];
+			bones[i] = b[i].getByName(effectors[round % effectorCount]);
+			targetX[i] = bones[i]->getFrameX() + (rand() % 300 - 150);
+			targetY[i] = bones[i]->getFrameY() + (rand() % 300 - 150);
+		}
+
+		simd.solve(&skeletons[0],&bones[0],&targetX[0],&targetY[0],LANES,solved);
+
+		for(int i = 0; i < LANES; ++i)
+		{
+			skl::Bone* bone = a[i].getByName(effectors[round % effectorCount]);
+			bool scalarSolved = scalar.solve(&a[i],bone,targetX[i],targetY[i]);
+			float dx = bone->getFrameX() - bones[i]->getFrameX();
+			float dy = bone->getFrameY() - bones[i]->getFrameY();
+			float difference = sqrt(dx * dx + dy * dy);
+
+			//A step ending within rounding of the radius may stop either solver a joint early
+			if(fabs(distanceTo(bone,targetX[i],targetY[i]) - radius) < TOLERANCE ||
+				fabs(distanceTo(bones[i],targetX[i],targetY[i]) - radius) < TOLERANCE)
+			{
+				boundaryCases++;
+				continue;
+			}
+
+			if(scalarSolved != solved[i] || difference > TOLERANCE)
+			{
+				printf("%s round %d lane %d: solved %d/%d, ends %g apart\n",
+					effectors[round % effectorCount],round,i,scalarSolved,solved[i],difference);
+				failures++;
+			}
+
+			if(difference > worst)
+			{
+				worst = difference;
+			}
+		}
+	}
+
+	printf("%d solves, %d at the radius, worst difference %g, %d failures\n",
+		LANES * ROUNDS,boundaryCases,worst,failures);
+	return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,128 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+//Writes a journal, reopens it and checks that Skeleton::load replays it.
+//Run from the repository root, or pass the path of a skeleton file.
+#include "SKALE/Skeleton.hpp"
+#include "SKALE/SkeletonJournal.hpp"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+static const float TOLERANCE = 0.001f;
+static const int EDITS = 50;
+
+static bool matches( skl::Skeleton& expected, skl::Skeleton& actual )
+{
+	const skl::FlatSkeleton& bones = expected.getFlatBones();
+	if(bones.count() != actual.getFlatBones().count())
+	{
+		printf("%d bones replayed, %d expected\n",actual.getFlatBones().count(),bones.count());
+		return false;
+	}
+
+	for(int i = 0; i < bones.count(); ++i)
+	{
+		const skl::Bone* a = bones.getBone(i);
+		const skl::Bone* b = i == 0 ? actual.getRoot() : actual.getByName(a->getName());
+		if(!b || fabs(a->getX() - b->getX()) > TOLERANCE ||
+			fabs(a->getY() - b->getY()) > TOLERANCE ||
+			fabs(a->getAngle() - b->getAngle()) > TOLERANCE ||
+			fabs(a->getLength() - b->getLength()) > TOLERANCE)
+		{
+			printf("%s does not match after replay\n",a->getName().c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	const char* source = argc > 1 ? argv[1] : "example/Skeleton.txt";
+	std::string fileName = "SkeletonJournalTest.txt";
+
+	skl::Skeleton skeleton;
+	if(!skeleton.load(source) || !skeleton.save(fileName))
+	{
+		printf("cannot copy %s\n",source);
+		return 1;
+	}
+
+	int failures = 0;
+	srand(1);
+	{
+		//Enough room that every edit stays in the journal
+		skl::SkeletonJournal journal(&skeleton,fileName);
+		journal.setCompactThreshold(EDITS * 1000);
+		const skl::FlatSkeleton& bones = skeleton.getFlatBones();
+		for(int edit = 0; edit < EDITS; ++edit)
+		{
+			skl::Bone* bone = bones.getBone(1 + rand() % (bones.count() - 1));
+			bone->setAngle((rand() % 6283) / 1000.0f - 3.14f);
+			bone->setLength((float)(rand() % 200));
+			journal.record();
+		}
+		skeleton.setPosition(123.5f,-45.25f);
+		journal.record();
+
+		if(journal.getEntryCount() == 0)
+		{
+			printf("nothing was journaled\n");
+			failures++;
+		}
+	}
+
+	//A new journal on the same files must append to the old one, not restamp it
+	{
+		skl::Skeleton reopened;
+		if(!reopened.load(fileName) || !matches(skeleton,reopened))
+		{
+			failures++;
+		}
+
+		skl::SkeletonJournal journal(&reopened,fileName);
+		reopened.getFlatBones().getBone(1)->setAngle(1.25f);
+		journal.record();
+		skeleton.getFlatBones().getBone(1)->setAngle(1.25f);
+	}
+
+	skl::Skeleton replayed;
+	if(!replayed.load(fileName) || !matches(skeleton,replayed))
+	{
+		failures++;
+	}
+
+	remove(fileName.c_str());
+	remove(skl::SkeletonJournal::getJournalName(fileName).c_str());
+	printf("%d edits replayed, %d failures\n",EDITS,failures);
+	return failures > 0 ? 1 : 0;
+}
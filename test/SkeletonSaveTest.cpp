@@ -0,0 +1,121 @@
+/* SKALE - 2D SKeletal Animation Layer for Entities
+ * Copyright (c) 2011 Joshua Larouche
+ * 
+ *
+ * License: (BSD)
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of SKALE nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ * TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+//Checks that Skeleton::save writes numbers exactly as ostream's default
+//formatting did before the writer stopped using streams.
+#include "SKALE/Skeleton.hpp"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static std::string streamed( float value )
+{
+	std::ostringstream out;
+	out << value;
+	return out.str();
+}
+
+int main(int argc, char* argv[])
+{
+	const char* fileName = argc > 1 ? argv[1] : "SkeletonSaveTest.txt";
+
+	//Around every switch to an exponent, every carry and every tie
+	const float edges[] = { 0.0f, -0.0f, 1.0f, -1.0f, 0.1f, 0.5f, 2.5f, 3.5f,
+		1.0f / 3.0f, 9.999996f, 9.999994f, 99999.95f, 123456.5f, 999999.0f,
+		999999.4f, 999999.5f, 999999.6f, -999999.5f, 1e6f, 1234567.0f, 1e7f,
+		1e-4f, 9.99999e-5f, 9.999996e-5f, 0.000123456f, 1e-5f, 5e-5f,
+		0.00100001f, 65535.5f, 6.283f, -3.14159f, 1e30f, -1e-30f };
+	std::vector<float> values(edges,edges + sizeof(edges) / sizeof(edges[0]));
+
+	//Random values across every decade the writer formats itself
+	srand(1);
+	for(int i = 0; i < 20000; ++i)
+	{
+		float mantissa = (rand() % 2000001 - 1000000) / 100000.0f;
+		values.push_back(mantissa * (float)pow(10.0,rand() % 12 - 6));
+	}
+
+	//x, y and length are written as they are, one value per bone
+	skl::Skeleton skeleton;
+	for(size_t i = 0; i < values.size(); ++i)
+	{
+		std::ostringstream name;
+		name << "Bone" << i;
+		skeleton.add(values[i],values[i],0.0f,values[i],0.0f,0.0f,name.str());
+	}
+
+	if(!skeleton.save(fileName))
+	{
+		printf("cannot save %s\n",fileName);
+		return 1;
+	}
+
+	std::ifstream file(fileName);
+	std::string line;
+	int failures = 0;
+	size_t checked = 0;
+	while(std::getline(file,line) && checked < values.size())
+	{
+		std::istringstream fields(line);
+		std::string level, x, y, angle, length;
+		fields >> level >> x >> y >> angle >> length;
+		//Level 0 is ROOT, which the loop above did not set
+		if(level == "0")
+		{
+			continue;
+		}
+
+		std::string expected = streamed(values[checked]);
+		if(x != expected || y != expected || length != expected)
+		{
+			if(failures < 10)
+			{
+				printf("%.9g: wrote %s %s %s, ostream writes %s\n",
+					values[checked],x.c_str(),y.c_str(),length.c_str(),expected.c_str());
+			}
+			failures++;
+		}
+		checked++;
+	}
+	remove(fileName);
+
+	if(checked != values.size())
+	{
+		printf("read back %d of %d bones\n",(int)checked,(int)values.size());
+		return 1;
+	}
+
+	printf("%d values, %d failures\n",(int)checked,failures);
+	return failures > 0 ? 1 : 0;
+}